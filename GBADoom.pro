@@ -18,6 +18,9 @@ DEFINES += _CRT_SECURE_NO_WARNINGS
 
 win32-g++: DEFINES += GBA
 
+# Draw spans and columns through the RP2040 interpolator model.
+#DEFINES += INTERP_KERNELS
+
 # You can also make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
@@ -86,6 +89,7 @@ SOURCES += \
         source/tables.c \
         source/v_video.c \
         source/version.c \
+        source/w_lz.c \
         source/w_wad.c \
         source/wi_stuff.c \
         source/z_bmalloc.c \
@@ -153,6 +157,7 @@ HEADERS += \
     include/r_data.h \
     include/r_defs.h \
     include/r_draw.h \
+    include/r_interp.h \
     include/r_main.h \
     include/r_patch.h \
     include/r_plane.h \
@@ -168,6 +173,7 @@ HEADERS += \
     include/tables.h \
     include/v_video.h \
     include/version.h \
+    include/w_lz.h \
     include/w_wad.h \
     include/wi_stuff.h \
     include/z_bmalloc.h \
@@ -59,7 +59,8 @@ enum {
   ML_NODES,             // BSP nodes
   ML_SECTORS,           // Sectors, from editing
   ML_REJECT,            // LUT, sector-sector visibility
-  ML_BLOCKMAP           // LUT, motion clipping, walls/grid element
+  ML_BLOCKMAP,          // LUT, motion clipping, walls/grid element
+  ML_PVS                // Optional, subsector visibility from wadopt -pvs
 };
 
 
@@ -156,6 +157,29 @@ typedef struct {
   short tag;
 } PACKEDATTR mapsector_t;
 
+// PVS lump header. One row per sector follows at rowofs,
+// numnodes node bits then numsubsectors subsector bits, with
+// runs of zero bytes stored as a zero and a count.
+typedef struct {
+  unsigned short numsectors;
+  unsigned short numnodes;
+  unsigned short numsubsectors;
+  unsigned short rowbytes;      // Decompressed row size.
+  unsigned int   nodeshash;     // PVS_NodesHash of the NODES it was built from.
+  unsigned int   rowofs[1];     // From the start of the lump, numsectors of them.
+} mappvs_t;
+
+// FNV-1a over the NODES lump, so a PVS is only used with its own tree.
+static inline unsigned int PVS_NodesHash(const unsigned char* data, int size)
+{
+  unsigned int h = 2166136261u;
+
+  while (size-- > 0)
+    h = (h ^ *data++) * 16777619u;
+
+  return h;
+}
+
 // SubSector, as generated by BSP.
 typedef struct {
   unsigned short numsegs;
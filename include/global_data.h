@@ -365,6 +365,10 @@ fixed_t   tmxmove;
 fixed_t   tmymove;
 
 mobj_t*   linetarget; // who got hit (or NULL)
+
+// First target the mask made P_AimLineAttack pass over, see P_AimFallback
+mobj_t*   aimfallback;
+fixed_t   aimfallbackslope;
 mobj_t*   shootthing;
 
 // Height if not aiming up or down
@@ -420,6 +424,14 @@ divline_t trace;
 // 1/11/98 killough: Intercept limit removed
 intercept_t intercepts[MAXINTERCEPTS];
 intercept_t* intercept_p;
+unsigned int interceptspeak, interceptoverflows; // see P_PrintInterceptStats
+
+// Lines of the mapblocks the traces of a fan have walked, see P_StartFan
+int fandepth;
+int numfanblocks, numfanlines;
+fanblock_t fanblocks[MAXFANBLOCKS];
+fanline_t fanlines[MAXFANLINES];
+unsigned char fanhash[FANHASHSIZE]; // fanblocks index + 1, 0 if free
 
 //******************************************************************************
 //p_mobj.c
@@ -456,6 +468,11 @@ const seg_t    *segs;
 int      numsectors;
 sector_t *sectors;
 
+// Sound flooding graph, see P_NoiseAlert.
+unsigned short *sectoredges;    // first soundedges entry of each sector, numsectors + 1
+unsigned short *soundedges;     // neighbour sector number | SE_SOUNDBLOCK
+unsigned short *soundqueue;     // numsectors
+
 
 int      numsubsectors;
 subsector_t *subsectors;
@@ -480,6 +497,7 @@ side_t   *sides;
 // Blockmap size.
 
 int       bmapwidth, bmapheight;  // size in mapblocks
+int       bmapshift;              // MAPBLOCKSHIFT
 
 // killough 3/1/98: remove blockmap limit internally:
 const short      *blockmap;              // was short -- killough
@@ -490,6 +508,7 @@ const short      *blockmaplump;          // was short -- killough
 fixed_t   bmaporgx, bmaporgy;     // origin of block map
 
 mobj_t    **blocklinks;           // for thing chains
+int       tbmapwidth, tbmapheight; // size in THINGBLOCKSHIFT blocks
 
 //
 // REJECT
@@ -503,11 +522,25 @@ mobj_t    **blocklinks;           // for thing chains
 int rejectlump;// cph - store reject lump num if cached
 const byte *rejectmatrix; // cph - const*
 
+//
+// PVS
+// Optional lump from wadopt -pvs: for each sector, the
+// nodes and subsectors that can be seen from inside it.
+//
+
+const mappvs_t *pvs;    // NULL if the map has none
+byte *pvsrow;           // unpacked row of pvssector
+int pvssector;
+
 // Maintain single and multi player starting spots.
 mapthing_t playerstarts[MAXPLAYERS];
 
 mobj_t*      thingPool;
+mobjcold_t*  thingCold;    // cold records of thingPool, same index
 unsigned int thingPoolSize;
+mobj_t*      thingFreeList; // chained through thinker.next
+unsigned int thingPoolUsed, thingPoolPeak, thingPoolOverflow;
+unsigned int thingsDormant; // mobjs parked by P_SleepThing
 
 
 //******************************************************************************
@@ -516,6 +549,10 @@ unsigned int thingPoolSize;
 
 los_t los; // cph - made static
 
+sightcache_t sightcache[SIGHTCACHESIZE];
+unsigned int sightversion; // bumped by T_MovePlane, stales the cache
+unsigned int sightchecks, sighthits;
+
 //******************************************************************************
 //p_spec.c
 //******************************************************************************
@@ -542,6 +579,11 @@ int leveltime; // tics in game play for par
 // killough 8/29/98: we maintain several separate threads, each containing
 // a special class of thinkers, to allow more efficient searches.
 thinker_t thinkerclasscap[th_all+1];
+thinkerarray_t thinkerbatches[NUMTHINKERBATCHES]; // see P_NewBatchThinker
+thinker_t* nextthinker; // P_RunThinkers' next node, NULL outside it
+
+unsigned int thinkertime; // microseconds in P_RunThinkers this level
+unsigned int thinkertics;
 
 //******************************************************************************
 //p_user.c
@@ -559,8 +601,15 @@ boolean onground; // whether player is on ground or in air
 //r_data.c
 //******************************************************************************
 
-int       firstflat, numflats;
-int       firstspritelump, lastspritelump, numspritelumps;
+// Flat and sprite numbers to lumps, merged over all wads.
+short*    flatlumps;
+int       numflats;
+short*    spritelumps;
+int       numspritelumps;
+
+// Flat name hash for R_FlatNumForName.
+short*    flathash;
+int       flathashbits;
 int       numtextures;
 
 //Store last lookup and return that if they match.
@@ -591,8 +640,8 @@ unsigned short validcount;         // increment every time a check is made
 //******************************************************************************
 
 visplane_t *visplanes[MAXVISPLANES];   // killough
-visplane_t *freetail;                  // killough
-visplane_t **freehead;     // killough
+visplane_t *freeplanes[2];             // narrow and wide, see new_visplane
+unsigned int numvisplanes, visplanespeak;
 
 
 
@@ -612,11 +661,19 @@ visplane_t **freehead;     // killough
 //
 // regular wall
 //
+// Also the per frame render arena. Drawsegs fill it from the start,
+// openings and vissprites from the end down to lastopening.
 drawseg_t drawsegs[MAXDRAWSEGS];
 
-short openings[MAXOPENINGS];
 short* lastopening;
 
+// Render arena high water marks and overflows, see R_PrintRenderStats
+unsigned int drawsegspeak, visspritespeak, arenapeak;
+unsigned int drawsegoverflows, openingoverflows, visspriteoverflows;
+
+// Colormap slot copies this frame, the worst frame and in all
+unsigned int colormapcopies, colormapcopiespeak, colormapcopiestotal;
+
 
 
 //******************************************************************************
@@ -643,8 +700,6 @@ int numsprites;
 spriteframe_t sprtemp[MAX_SPRITE_FRAMES];
 int maxframe;
 
-vissprite_t vissprites[MAXVISSPRITES];
-
 
 //******************************************************************************
 //s_sound.c
@@ -752,6 +807,37 @@ boolean st_statusbaron;
 // Each screen is [SCREENWIDTH*SCREENHEIGHT];
 screeninfo_t screens[NUM_SCREENS];
 
+//******************************************************************************
+//w_wad.c
+//******************************************************************************
+
+// IWAD first, then PWADs whose lumps override it.
+wadfile_t wadfiles[MAXWADFILES];
+int numwadfiles;
+int numlumps;
+
+// Lump name hash over all wads. Chains run from
+// later lumps to earlier ones.
+short* lumphash;
+short* lumpnext;
+int lumphashbits;
+
+// Block device the wad is read from, NULL for the built in wad.
+w_readfunc_t wadread;
+
+// Zone copies of lumps that can't be read in place,
+// NULL if every lump can.
+lumpcache_t* lumpcache;
+
+// Unlocked cached lumps, most recently used first.
+int lruhead, lrutail;
+unsigned int lumpcachebytes;
+
+unsigned int lumpcachehits;
+unsigned int lumpcachemisses;
+unsigned int lumpcacheevictions;
+unsigned int lumpcachereadbytes;
+
 //******************************************************************************
 //wi_stuff.c
 //******************************************************************************
@@ -55,9 +55,6 @@ _g->rejectlump = -1;// cph - store reject lump num if cached
 _g->validcount = 1;         // increment every time a check is made
 
 
-_g->freehead = &_g->freetail;     // killough
-
-
 //******************************************************************************
 //s_sounds.c
 //******************************************************************************
@@ -41,6 +41,7 @@
 boolean I_StartDisplay(void);
 void I_EndDisplay(void);
 int I_GetTime(void);     /* killough */
+unsigned int I_GetTimeMicros(void);  /* free running, for profiling */
 
 /* cphipps - I_GetVersionString
  * Returns a version string in the given buffer
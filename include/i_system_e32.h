@@ -28,6 +28,13 @@ void I_Error (const char *error, ...);
 
 void I_Quit_e32();
 
+// Block device holding an external wad, e.g. an SD card.
+// Returns non zero if there is a wad on it.
+int I_OpenWad_e32(void);
+
+// Reads len bytes at offset, returns the number of bytes read.
+int I_ReadWad_e32(unsigned int offset, void* dest, int len);
+
 unsigned short* I_GetBackBuffer();
 
 unsigned short* I_GetFrontBuffer();
@@ -37,17 +37,29 @@
 #include "r_defs.h"
 
 /* mapblocks are used to check movement against lines and things */
-#define MAPBLOCKUNITS   128
+/* 128 units unless wadopt rebuilt the blockmap finer, see P_LoadBlockMap */
+#define MAPBLOCKSHIFT   (_g->bmapshift)
+#define MAPBLOCKUNITS   (1<<(MAPBLOCKSHIFT-FRACBITS))
 #define MAPBLOCKSIZE    (MAPBLOCKUNITS*FRACUNIT)
-#define MAPBLOCKSHIFT   (FRACBITS+7)
 #define MAPBMASK        (MAPBLOCKSIZE-1)
 #define MAPBTOFRAC      (MAPBLOCKSHIFT-FRACBITS)
 
+/* Things are linked into blocks of 128 units from the same origin,
+ * whatever the line blocks are. A thing sits in the block holding its
+ * centre, and the MAXRADIUS padding of thing searches relies on that
+ * block size. */
+#define THINGBLOCKSHIFT (FRACBITS+7)
+
 #define PT_ADDLINES     1
 #define PT_ADDTHINGS    2
 #define PT_EARLYOUT     4
 
+/* Traces that cross more than this give up without hitting anything,
+ * so changing it can desync demos. P_PrintInterceptStats reports how
+ * close a level comes. */
+#ifndef MAXINTERCEPTS
 #define MAXINTERCEPTS 64
+#endif
 
 typedef struct
 {
@@ -75,6 +87,34 @@ typedef struct {
   fixed_t maxz,minz;               // cph - z optimisations for 2sided lines
 } los_t;
 
+/* A remembered P_CheckSight answer. The key is every input the trace
+ * reads, so a hit gives exactly what the trace would have. */
+typedef struct {
+  fixed_t t1x, t1y, sightz;        // looker and its eye height
+  fixed_t t2x, t2y, t2z, t2h;      // target
+  unsigned int version;            // sightversion it was traced at
+  boolean result;
+} sightcache_t;
+
+#define SIGHTCACHESIZE 32          // direct mapped, power of 2
+
+/* A mapblock's lines copied to RAM while a fan of traces is open,
+ * see P_StartFan. */
+typedef struct {
+  divline_t dl;                    // v1 and v2 - v1 of the line
+  unsigned short lineno;
+} fanline_t;
+
+typedef struct {
+  int block;                       // y*bmapwidth+x
+  unsigned short firstline;        // into fanlines
+  unsigned short numlines;
+} fanblock_t;
+
+#define MAXFANBLOCKS 48
+#define MAXFANLINES 128
+#define FANHASHSIZE 64             // power of 2, > MAXFANBLOCKS
+
 typedef boolean (*traverser_t)(intercept_t *in);
 
 fixed_t CONSTFUNC P_AproxDistance (fixed_t dx, fixed_t dy);
@@ -90,5 +130,8 @@ boolean P_BlockLinesIterator (int x, int y, boolean func(const line_t *));
 boolean P_BlockThingsIterator(int x, int y, boolean func(mobj_t *));
 boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
                        int flags, boolean trav(intercept_t *));
+void    P_PrintInterceptStats(void);
+void    P_StartFan(void);
+void    P_EndFan(void);
 
 #endif  /* __P_MAPUTL__ */
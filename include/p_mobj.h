@@ -204,8 +204,9 @@
 // Hmm ???.
 #define MF_TRANSSHIFT 26
 
-#define MF_POOLED      (unsigned int)(0x0000000010000000)
-#define MF_UNUSED       (unsigned int)(0x0000000020000000)
+#define MF_UNUSED       (unsigned int)(0x0000000010000000)
+// Off the thinker list until something disturbs it, see P_SleepThing.
+#define MF_DORMANT      (unsigned int)(0x0000000020000000)
 
     // Translucent sprite?                                          // phares
 #define MF_TRANSLUCENT  (unsigned int)(0x0000000040000000)
@@ -238,6 +239,9 @@ enum {
 /* cph 2006/08/28 - move Prev[XYZ] fields to the end of the struct. Add any
  * other new fields to the end, and make sure you don't break savegames! */
 
+/* Hot record: everything the thinker loop, movement and the renderer
+ * touch every tic. R_AddSprites/R_ProjectSprite only read the dense
+ * view up to and including type, so keep those fields together. */
 typedef struct mobj_s
 {
     // List: thinker links.
@@ -250,17 +254,23 @@ typedef struct mobj_s
 
     // More list: links in sector (if needed)
     struct mobj_s*      snext;
-    struct mobj_s**     sprev; // killough 8/10/98: change to ptr-to-ptr
 
     //More drawing info: to determine current sprite.
     angle_t             angle;  // orientation
     unsigned short      sprite; // used to find patch_t and flip value
     unsigned short      frame;  // might be ORed with FF_FULLBRIGHT
 
+    unsigned int        flags;
+
+    unsigned short      type;
+
+    // End of the renderer's view.
+
+    short               health;
+
     // Interaction info, by BLOCKMAP.
     // Links in blocks (if needed).
     struct mobj_s*      bnext;
-    struct mobj_s**     bprev; // killough 8/11/98: change to ptr-to-ptr
 
     struct subsector_s* subsector;
 
@@ -268,9 +278,6 @@ typedef struct mobj_s
     fixed_t             floorz;
     fixed_t             ceilingz;
 
-    // killough 11/98: the lowest floor over all contacted Sectors.
-    fixed_t             dropoffz;
-
     // For movement checking.
     fixed_t             radius;
     fixed_t             height;
@@ -280,48 +287,59 @@ typedef struct mobj_s
     fixed_t             momy;
     fixed_t             momz;
 
-    short               health;
-
-    unsigned short      type;
-
     int                 tics;   // state tic counter
     const state_t*      state;
-    unsigned int        flags;
 
     // Thing being chased/attacked (or NULL),
     // also the originator for missiles.
     struct mobj_s*      target;
 
-    // Movement direction, movement generation (zig-zagging).
-
-    unsigned short movedir: 4;
-
-    // If >0, the current target will be chased no
-    // matter what (even if shot by another object)
-    unsigned short               threshold:8;
-
-
-    // killough 9/9/98: How long a monster pursues a target.
-    unsigned short      pursuecount;
-
     short               movecount;      // when 0, select a new dir
 
     // Reaction time: if non 0, don't attack yet.
     // Used by player to freeze a bit after teleporting.
     short               reactiontime;
 
+    // SEE WARNING ABOVE ABOUT POINTER FIELDS!!!
+} mobj_t;
+
+/* Cold record: back links only used when relinking, monster AI state
+ * and dropoff tracking. Pool slots keep theirs in thingCold at the same
+ * index, zone allocated mobjs carry it right behind the mobj_t. Pool
+ * slots are told apart by address, so no write to flags can lose it. */
+typedef struct mobjcold_s
+{
+    struct mobj_s**     sprev; // killough 8/10/98: change to ptr-to-ptr
+    struct mobj_s**     bprev; // killough 8/11/98: change to ptr-to-ptr
+
+                                       // phares 3/17/98
+    // a linked list of sectors where this object appears
+    struct msecnode_s* touching_sectorlist;                 // phares 3/14/98
+
     // Thing being chased/attacked for tracers.
     struct mobj_s*      tracer;
 
     // new field: last known enemy -- killough 2/15/98
     struct mobj_s*      lastenemy;
 
-                                       // phares 3/17/98
-    // a linked list of sectors where this object appears
-    struct msecnode_s* touching_sectorlist;                 // phares 3/14/98
+    // killough 11/98: the lowest floor over all contacted Sectors.
+    fixed_t             dropoffz;
 
-    // SEE WARNING ABOVE ABOUT POINTER FIELDS!!!
-} mobj_t;
+    // killough 9/9/98: How long a monster pursues a target.
+    unsigned short      pursuecount;
+
+    // If >0, the current target will be chased no
+    // matter what (even if shot by another object)
+    unsigned char       threshold;
+
+    // Movement direction, movement generation (zig-zagging).
+    unsigned char       movedir;
+} mobjcold_t;
+
+#define P_MobjPooled(mo) ((mo) >= _g->thingPool && (mo) < _g->thingPool + _g->thingPoolSize)
+
+#define P_MobjCold(mo) (P_MobjPooled(mo) ? \
+    &_g->thingCold[(mo) - _g->thingPool] : (mobjcold_t*)((mo) + 1))
 
 // External declarations (fomerly in p_local.h) -- killough 5/2/98
 
@@ -336,6 +354,10 @@ typedef struct mobj_s
 // Time interval for item respawning.
 #define ITEMQUESIZE     32
 
+// Mobj pool slots kept on top of the map's things for
+// missiles, puffs, blood and the like.
+#define MOBJRESERVE     64
+
 #define FLOATSPEED      (FRACUNIT*4)
 #define STOPSPEED       (FRACUNIT/16)
 
@@ -566,9 +566,9 @@ typedef struct
 
 } lightflash_t;
 
+// Strobes and glows are batched, see P_NewBatchThinker.
 typedef struct
 {
-  thinker_t thinker;
   sector_t* sector;
   int count;
   int minlight;
@@ -580,7 +580,6 @@ typedef struct
 
 typedef struct
 {
-  thinker_t thinker;
   sector_t* sector;
   int minlight;
   int maxlight;
@@ -706,7 +705,6 @@ typedef struct
 // killough 3/7/98: Add generalized scroll effects
 
 typedef struct {
-  thinker_t thinker;   // Thinker structure for scrolling
   int affectee;        // Number of affected sidedef, sector, tag, or whatever
 } scroll_t;
 
@@ -878,15 +876,17 @@ void P_ChangeSwitchTexture
 void T_LightFlash
 ( lightflash_t* flash );
 
-void T_StrobeFlash
-( strobe_t* flash );
+void T_StrobeFlashes
+( strobe_t* flash,
+  unsigned int count );
 
 // jff 8/8/98 add missing thinker for flicker
 void T_FireFlicker
 ( fireflicker_t* flick );
 
-void T_Glow
-( glow_t* g );
+void T_Glows
+( glow_t* g,
+  unsigned int count );
 
 // p_plats
 
@@ -921,8 +921,9 @@ void T_MoveElevator
 
 // p_spec
 
-void T_Scroll
-( scroll_t * );      // killough 3/7/98: scroll effect thinker
+void T_Scrollers
+( scroll_t *,
+  unsigned int count );      // killough 3/7/98: scroll effect thinker
 
 ////////////////////////////////////////////////////////////////
 //
@@ -44,12 +44,46 @@
 
 void P_Ticker(void);
 
+/* Special thinkers come from a pool per struct, in the level arena. */
+typedef enum
+{
+  tp_ceiling,
+  tp_door,
+  tp_floor,
+  tp_elevator,
+  tp_plat,
+  tp_fireflicker,
+  tp_lightflash,
+  tp_dormant,
+  NUMTHINKERPOOLS
+} thinkerpool_t;
+
+/* Thinkers that never touch play state or P_Random are kept out of the
+ * thinker list in a dense array per class, which P_RunThinkers runs in
+ * one loop after the list. They live for the whole level. */
+typedef enum
+{
+  tb_strobe,
+  tb_glow,
+  tb_scroll,
+  NUMTHINKERBATCHES
+} thinkerbatch_t;
+
+typedef struct
+{
+  void *data;
+  unsigned int count, max;
+} thinkerarray_t;
+
 void P_InitThinkers(void);
+void* P_NewThinker(thinkerpool_t pool);
+void* P_NewBatchThinker(thinkerbatch_t batch);
 void P_AddThinker(thinker_t *thinker);
-void P_RemoveThinker(thinker_t *thinker);
+void P_RemoveThinker(thinker_t *thinker, thinkerpool_t pool);
 void P_RemoveThing(mobj_t *thing);
-void P_RemoveThinkerDelayed(thinker_t *thinker);    // killough 4/25/98
 void P_RemoveThingDelayed(thinker_t *thinker);
+void P_SleepThing(mobj_t *thing);
+void P_WakeThing(mobj_t *thing);
 
 
 void P_UpdateThinker(thinker_t *thinker);   // killough 8/29/98
@@ -92,6 +92,7 @@ int R_CheckTextureNumForName (const char *name);
 
 const texture_t* R_GetTexture(int texture);
 int R_LoadTextureByName(const char* tex_name);
+void R_UnlockTexturePatches(void);
 
 
 
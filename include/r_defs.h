@@ -59,12 +59,6 @@
 #define SIL_TOP     2
 #define SIL_BOTH    3
 
-#define MAXDRAWSEGS   192
-
-#define MAXOPENINGS (SCREENWIDTH*16)
-
-#define MAXVISSPRITES 96
-
 //
 // INTERNAL MAP TYPES
 //  used by play and refresh
@@ -127,6 +121,9 @@ typedef struct
 
 } sector_t;
 
+// Set in a soundedges entry if every line to that neighbour blocks sound.
+#define SE_SOUNDBLOCK 0x8000
+
 //
 // The SideDef.
 //
@@ -360,6 +357,7 @@ typedef struct vissprite_s
   fixed_t iscale;
 
   const patch_t* patch;
+  int lump;                    // patch lump, locked until drawn
 
   unsigned int mobjflags;
 
@@ -368,6 +366,20 @@ typedef struct vissprite_s
 
 } vissprite_t;
 
+//
+// Drawsegs, openings and vissprites share one render arena a frame.
+// Drawsegs fill it from the start, openings and vissprites from the
+// end, so a big fight can use the room a busy skyline would have.
+// The default is what their old fixed arrays took: 192 drawsegs,
+// SCREENWIDTH*16 openings and 96 vissprites. R_PrintRenderStats
+// reports the high water marks to size it for an IWAD by.
+//
+#ifndef RENDERBUDGET
+#define RENDERBUDGET (192*sizeof(drawseg_t) + SCREENWIDTH*16*sizeof(short) + 96*sizeof(vissprite_t))
+#endif
+
+#define MAXDRAWSEGS (RENDERBUDGET / sizeof(drawseg_t))
+
 //
 // Sprites are patches with a special naming convention
 //  so they can be recognized by R_InitSprites.
@@ -427,17 +439,12 @@ typedef struct visplane
   fixed_t height;
   boolean modified;
 
-  byte		pad1;
-  byte		pad2;
-  byte		pad3;
-  // Here lies the rub for all
-  //  dynamic resize/change of resolution.
-  byte		top[SCREENWIDTH];
-  byte		pad4;
-  byte		pad5;
-  // See above.
-  byte		bottom[SCREENWIDTH];
-  byte		pad6;
+  // Only columns base to base+width-1 can be marked. Most planes are
+  // narrow, VISPLANENARROW columns, and get widened to the whole
+  // screen if they outgrow that. top and bottom are offset so they
+  // are indexed by screen x, and [base-1] and [base+width] are pads.
+  short base, width;
+  byte *top, *bottom;
 
 } visplane_t;
 
@@ -0,0 +1,103 @@
+#ifndef R_INTERP_H
+#define R_INTERP_H
+
+#include <stdint.h>
+
+//
+// RP2040 SIO interpolator, as the span and column kernels use it.
+//
+// On RP2040 this is interp0 of the core doing the rendering. Other
+// builds get a software model that gives the same results bit for
+// bit, so the kernels can be run and checked on the host.
+//
+// Each lane takes its accumulator (or the other lane's, CROSS_INPUT),
+// shifts it right and masks it. A lane result is its base plus that,
+// or plus the unshifted input with ADD_RAW. The full result is base2
+// plus both shifted and masked values. A pop returns a result and
+// writes both lane results back to the accumulators, so a lane with
+// ADD_RAW and its step in base steps once per pop.
+//
+
+// Lane control bits, laid out as in SIO_INTERP0_CTRL_LANE0.
+#define INTERP_SIGNED       (1u << 15)
+#define INTERP_CROSS_INPUT  (1u << 16)
+#define INTERP_ADD_RAW      (1u << 18)
+
+#define INTERP_CTRL(shift, masklsb, maskmsb, flags) \
+    ((unsigned int)(shift) | ((unsigned int)(masklsb) << 5) | ((unsigned int)(maskmsb) << 10) | (flags))
+
+#ifdef RP2040
+
+#include "hardware/interp.h"
+
+typedef interp_hw_t r_interp_t;
+
+#define R_INTERP interp0
+
+inline static uintptr_t R_InterpPopFull(r_interp_t* interp)
+{
+    return interp->pop[2];
+}
+
+#else
+
+// CROSS_RESULT and FORCE_MSB are not modelled, the kernels don't use
+// them. base2 is pointer sized so the full result can be an address.
+typedef struct
+{
+    unsigned int accum[2];
+    uintptr_t base[3];
+    unsigned int ctrl[2];
+} r_interp_t;
+
+extern r_interp_t r_interpmodel;
+
+#define R_INTERP (&r_interpmodel)
+
+inline static unsigned int R_InterpInput(const r_interp_t* interp, int lane)
+{
+    return interp->accum[(interp->ctrl[lane] & INTERP_CROSS_INPUT) ? lane ^ 1 : lane];
+}
+
+inline static unsigned int R_InterpShiftMask(const r_interp_t* interp, int lane)
+{
+    const unsigned int ctrl = interp->ctrl[lane];
+
+    const unsigned int shift = ctrl & 31;
+    const unsigned int masklsb = (ctrl >> 5) & 31;
+    const unsigned int maskmsb = (ctrl >> 10) & 31;
+
+    const unsigned int mask = (0xffffffffu >> (31 - maskmsb)) & (0xffffffffu << masklsb);
+
+    unsigned int value = (R_InterpInput(interp, lane) >> shift) & mask;
+
+    if ((ctrl & INTERP_SIGNED) && (value & (1u << maskmsb)))
+        value |= ~(0xffffffffu >> (31 - maskmsb));
+
+    return value;
+}
+
+inline static unsigned int R_InterpResult(const r_interp_t* interp, int lane)
+{
+    if (interp->ctrl[lane] & INTERP_ADD_RAW)
+        return (unsigned int)interp->base[lane] + R_InterpInput(interp, lane);
+
+    return (unsigned int)interp->base[lane] + R_InterpShiftMask(interp, lane);
+}
+
+inline static uintptr_t R_InterpPopFull(r_interp_t* interp)
+{
+    const uintptr_t full = interp->base[2] + R_InterpShiftMask(interp, 0) + R_InterpShiftMask(interp, 1);
+
+    const unsigned int result0 = R_InterpResult(interp, 0);
+    const unsigned int result1 = R_InterpResult(interp, 1);
+
+    interp->accum[0] = result0;
+    interp->accum[1] = result1;
+
+    return full;
+}
+
+#endif
+
+#endif // R_INTERP_H
@@ -48,6 +48,8 @@ void R_ResetPlanes();
 
 #define MAXVISPLANES 32    /* must be a power of 2 */
 
+#define VISPLANENARROW 32  /* columns in a narrow visplane, multiple of 4 */
+
 // killough -- hash function for visplanes
 // Empirically verified to be fairly uniform:
 
@@ -0,0 +1,24 @@
+#ifndef W_LZ_H
+#define W_LZ_H
+
+#include "doomtype.h"
+
+//
+// LZ4 block decoder for compressed lumps.
+//
+// A compressed lump is stored as a little endian int holding the
+// length of the LZ4 block, followed by the block itself. The
+// directory size of the lump is the decompressed length.
+//
+
+typedef struct
+{
+    int csize;
+    byte data[0];
+} lzlump_t;
+
+// Returns the number of bytes written to dest, or -1 if the
+// block is corrupt or doesn't fit in destlen bytes.
+int W_LZDecompress(const byte* src, int srclen, byte* dest, int destlen);
+
+#endif // W_LZ_H
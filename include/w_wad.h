@@ -55,11 +55,55 @@ typedef struct
   char name[8];
 } filelump_t;
 
+// A loaded wad. Lumps of all wads are numbered in load order,
+// this one's are firstlump to firstlump + numlumps - 1.
+typedef struct
+{
+  const filelump_t* lumpinfo;
+  const byte* data;       // wad read in place, NULL if on the block device
+  unsigned int base;      // offset of the wad on the block device
+  int firstlump;
+  int numlumps;
+} wadfile_t;
+
+#define MAXWADFILES 4
+
+// Compressed lumps have this bit set in filepos. The data at
+// filepos is a lzlump_t and size is the decompressed length.
+#define LUMP_COMPRESSED 0x80000000
+
+// Zone copy of a lump that can't be read in place. While locks is
+// non zero the block is PU_STATIC, otherwise it is PU_CACHE, sits
+// on the LRU list and may be purged. LUMPPINNED marks a lump that
+// stays locked for the rest of the run, see W_CacheLumpNumPinned.
+#define LUMPPINNED 0xffff
+
+typedef struct
+{
+  void* cache;
+  unsigned short locks;
+  short lruprev, lrunext;
+} lumpcache_t;
+
+// Bytes of lumps kept in the zone before the least recently
+// used unlocked ones are evicted. Locked lumps may exceed it.
+#ifndef LUMPCACHESIZE
+#define LUMPCACHESIZE (64*1024)
+#endif
+
+// Reads len bytes at offset from a block device holding a wad.
+// Returns the number of bytes read.
+typedef int (*w_readfunc_t)(unsigned int offset, void* dest, int len);
+
 
 // killough 4/17/98: if W_CheckNumForName() called with only
 // one argument, pass ns_global as the default namespace
 
 void W_Init(void); // CPhipps - uses the above array
+void W_SetBlockDevice(w_readfunc_t read);
+
+// Lump range of the x_START/x_END namespace in one wad.
+boolean W_GetNamespace(int file, char ns, int* first, int* last);
 
 int PUREFUNC W_CheckNumForName(const char* name);   // killough 4/17/98
 int PUREFUNC W_GetNumForName (const char* name);
@@ -69,10 +113,21 @@ const char* PUREFUNC W_GetNameForNum(int lump);
 int PUREFUNC W_LumpLength (int lump);
 
 // CPhipps - modified for 'new' lump locking
-const void* PUREFUNC W_CacheLumpNum (int lump);
+const void* W_CacheLumpNum (int lump);
+void W_UnlockLumpNum (int lump);
+
+// For lumps held until exit, like the status bar and font patches.
+// Never unlocked, so calling it again for the same lump is fine.
+const void* W_CacheLumpNumPinned (int lump);
+
+// Pulls lumps into the cache ahead of use, as far as they fit.
+void W_ReadAheadLumps(int lump, int count);
+void W_PrintCacheStats(void);
 
 // CPhipps - convenience macros
 #define W_CacheLumpName(name) W_CacheLumpNum(W_GetNumForName(name))
+#define W_UnlockLumpName(name) W_UnlockLumpNum(W_GetNumForName(name))
+#define W_CacheLumpNamePinned(name) W_CacheLumpNumPinned(W_GetNumForName(name))
 
 void ExtractFileBase(const char *, char *);       // killough
 
@@ -33,16 +33,19 @@
 
 struct block_memory_alloc_s {
   void  *firstpool;
-  size_t size;
+  void  *freelist;
+  size_t size;     // at least a pointer, elements hold the free list link
   size_t perpool;
   int    tag;
   const char *desc;
+  int    used, peak, pools;
 };
 
 #define DECLARE_BLOCK_MEMORY_ALLOC_ZONE(name) extern struct block_memory_alloc_s name
 #define IMPLEMENT_BLOCK_MEMORY_ALLOC_ZONE(name, size, tag, num, desc) \
-struct block_memory_alloc_s name = { NULL, size, num, tag, desc}
-#define NULL_BLOCK_MEMORY_ALLOC_ZONE(name) name.firstpool = NULL
+struct block_memory_alloc_s name = { NULL, NULL, size, num, tag, desc, 0, 0, 0}
+#define NULL_BLOCK_MEMORY_ALLOC_ZONE(name) \
+name.firstpool = name.freelist = NULL, name.used = name.peak = name.pools = 0
 
 void* Z_BMalloc(struct block_memory_alloc_s *pzone);
 
@@ -50,3 +53,5 @@ __inline static void* Z_BCalloc(struct block_memory_alloc_s *pzone)
 { void *p = Z_BMalloc(pzone); memset(p,0,pzone->size); return p; }
 
 void Z_BFree(struct block_memory_alloc_s *pzone, void* p);
+
+void Z_BPrintStats(const struct block_memory_alloc_s *pzone);
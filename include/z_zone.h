@@ -40,19 +40,34 @@
 // PU - purge tags.
 // Tags < 100 are not overwritten until freed.
 #define PU_STATIC		1	// static entire execution time
-#define PU_LEVEL		2	// static until level exited
-#define PU_LEVSPEC		3      // a special thinker in a level
+#define PU_LEVEL		2	// static until level exited, can't be freed before
+#define PU_LEVSPEC		3      // a special thinker in a level, or anything freed during it
 #define PU_CACHE		4
 
 #define PU_PURGELEVEL PU_CACHE
 
+typedef struct
+{
+    unsigned int freebytes;
+    unsigned int largestfree;    // biggest single allocation possible without purging
+    unsigned int purgablebytes;
+    int freeblocks;
+    int usedblocks;
+    int fragmentation;           // % of free memory outside the largest free block
+    unsigned int levelbytes;     // PU_LEVEL data in the level arena
+    int levelchunks;
+} zonestats_t;
+
 
 
 void	Z_Init (void);
 void*	Z_Malloc (int size, int tag, void **ptr);
 void    Z_Free (void *ptr);
 void    Z_FreeTags (int lowtag, int hightag);
+void    Z_ChangeTag (void *ptr, int tag);
 void    Z_CheckHeap (void);
+void    Z_GetStats (zonestats_t* stats);
+void    Z_PrintStats (void);
 void*   Z_Calloc(size_t count, size_t size, int tag, void **user);
 char*   Z_Strdup(const char* s);
 void*   Z_Realloc(void *ptr, size_t n, int tag, void **user);
@@ -72,7 +72,7 @@
 #include "am_map.h"
 #include "m_cheat.h"
 
-#include "doom_iwad.h"
+#include "i_system_e32.h"
 #include "global_data.h"
 
 void GetFirstMap(int *ep, int *map); // Ty 08/29/98 - add "-warp x" functionality
@@ -484,16 +484,13 @@ void D_StartTitle (void)
 // the gamemode from it. Also note if DOOM II, whether secret levels exist
 // CPhipps - const char* for iwadname, made static
 
-static void CheckIWAD2(const unsigned char* iwad_data, const unsigned int iwad_len, GameMode_t *gmode,boolean *hassec)
+static void CheckIWAD2(const filelump_t* fileinfo, const int numlumps, GameMode_t *gmode,boolean *hassec)
 {
-    const wadinfo_t* header = (const wadinfo_t*)iwad_data;
-
     int ud=0,rg=0,sw=0,cm=0,sc=0;
 
-    if(!strncmp(header->identification, "IWAD", 4))
+    if(fileinfo)
     {
-        size_t length = header->numlumps;
-        const filelump_t* fileinfo = (const filelump_t*)&iwad_data[header->infotableofs];
+        size_t length = numlumps;
 
         while (length--)
         {
@@ -584,7 +581,7 @@ static void CheckIWAD2(const unsigned char* iwad_data, const unsigned int iwad_l
 
 static void IdentifyVersion()
 {
-    CheckIWAD2(doom_iwad, doom_iwad_len, &_g->gamemode, &_g->haswolflevels);
+    CheckIWAD2(_g->wadfiles[0].lumpinfo, _g->wadfiles[0].numlumps, &_g->gamemode, &_g->haswolflevels);
 
     /* jff 8/23/98 set gamemission global appropriately in all cases
      * cphipps 12/1999 - no version output here, leave that to the caller
@@ -620,6 +617,14 @@ static void IdentifyVersion()
 
 static void D_DoomMainSetup(void)
 {
+    // An external wad on the block device wins over the built in one.
+    if(I_OpenWad_e32())
+        W_SetBlockDevice(I_ReadWad_e32);
+
+    //jff 9/3/98 use logical output routine
+    lprintf(LO_INFO,"W_Init: Init WADfiles.");
+    W_Init(); // CPhipps - handling of wadfiles init changed
+
     IdentifyVersion();
 
     // jff 1/24/98 end of set to both working and command line value
@@ -686,10 +691,6 @@ static void D_DoomMainSetup(void)
     lprintf(LO_INFO,"D_InitNetGame.");
     D_InitNetGame();
 
-    //jff 9/3/98 use logical output routine
-    lprintf(LO_INFO,"W_Init: Init WADfiles.");
-    W_Init(); // CPhipps - handling of wadfiles init changed
-
     //jff 9/3/98 use logical output routine
     lprintf(LO_INFO,"M_Init: Init misc info.");
     M_Init();
@@ -377,6 +377,10 @@ static void G_DoLoadLevel (void)
     // died.
 
     DECLARE_BLOCK_MEMORY_ALLOC_ZONE(secnodezone);
+
+    if (secnodezone.pools)
+        Z_BPrintStats(&secnodezone);
+
     NULL_BLOCK_MEMORY_ALLOC_ZONE(secnodezone);
 
 
@@ -1363,6 +1367,7 @@ boolean G_CheckDemoStatus (void)
 
         if (demolumpnum != -1)
         {
+            W_UnlockLumpNum(demolumpnum);
             demolumpnum = -1;
         }
         G_ReloadDefaults();    // killough 3/1/98
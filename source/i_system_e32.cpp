@@ -10,6 +10,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "i_system_e32.h"
 
@@ -203,4 +204,49 @@ void I_Quit_e32()
 
 //**************************************************************************************
 
+//Stand in for an SD card: the wads named by $DOOMWAD and
+//$DOOMPWAD, back to back on 512 byte boundaries.
+static FILE* wadfiles[2];
+static unsigned int wadoffsets[2];
+
+int I_OpenWad_e32(void)
+{
+    const char* names[2] = {getenv("DOOMWAD"), getenv("DOOMPWAD")};
+    unsigned int offset = 0;
+    int count = 0;
+
+    for(int i = 0; i < 2; i++)
+    {
+        if(!names[i] || !(wadfiles[count] = fopen(names[i], "rb")))
+            continue;
+
+        wadoffsets[count] = offset;
+
+        fseek(wadfiles[count], 0, SEEK_END);
+        offset = (offset + ftell(wadfiles[count]) + 511) & ~511;
+
+        count++;
+    }
+
+    return count;
+}
+
+//**************************************************************************************
+
+int I_ReadWad_e32(unsigned int offset, void* dest, int len)
+{
+    for(int i = 1; i >= 0; i--)
+    {
+        if(!wadfiles[i] || offset < wadoffsets[i])
+            continue;
+
+        if(fseek(wadfiles[i], offset - wadoffsets[i], SEEK_SET))
+            return 0;
+
+        return (int)fread(dest, 1, len, wadfiles[i]);
+    }
+
+    return 0;
+}
+
 #endif
@@ -347,4 +347,18 @@ void I_Quit_e32()
 
 //**************************************************************************************
 
+int I_OpenWad_e32(void)
+{
+    return 0;
+}
+
+//**************************************************************************************
+
+int I_ReadWad_e32(unsigned int offset, void* dest, int len)
+{
+    return 0;
+}
+
+//**************************************************************************************
+
 #endif
@@ -195,6 +195,186 @@ void I_ProcessKeyEvents() {
 
 //**************************************************************************************
 
+// microSD slot of the Thing Plus on SPI1. The wad is written raw
+// to the card from sector 0 (dd if=doom.wad of=/dev/sdX). The
+// parallel display shares these pins, so only SMALL_SPI reads it.
+#ifdef SMALL_SPI
+#define SD_SPI spi1
+#define PIN_SD_CS 9
+#define PIN_SD_SCK 14
+#define PIN_SD_MOSI 15
+#define PIN_SD_MISO 12
+#endif
+
+#ifdef SD_SPI
+
+#define SD_SECTOR 512
+
+static bool sd_blockaddr;
+static uint32_t sd_cached_sector = 0xffffffff;
+static uint8_t sd_sector[SD_SECTOR];
+
+static uint8_t sd_xfer(uint8_t out) {
+  uint8_t in;
+  spi_write_read_blocking(SD_SPI, &out, &in, 1);
+  return in;
+}
+
+static void sd_select(bool on) {
+  gpio_put(PIN_SD_CS, !on);
+  sd_xfer(0xff);
+}
+
+static uint8_t sd_command(uint8_t cmd, uint32_t arg) {
+  // Only CMD0 and CMD8 are sent before CRCs are off.
+  const uint8_t crc = (cmd == 0) ? 0x95 : (cmd == 8) ? 0x87 : 0x01;
+
+  sd_xfer(0x40 | cmd);
+  sd_xfer(arg >> 24);
+  sd_xfer(arg >> 16);
+  sd_xfer(arg >> 8);
+  sd_xfer(arg);
+  sd_xfer(crc);
+
+  uint8_t r;
+  for (int i = 0; i < 10; i++) {
+    if (!((r = sd_xfer(0xff)) & 0x80))
+      break;
+  }
+  return r;
+}
+
+static uint8_t sd_app_command(uint8_t cmd, uint32_t arg) {
+  sd_command(55, 0);
+  return sd_command(cmd, arg);
+}
+
+static bool sd_init(void) {
+  spi_init(SD_SPI, 400 * 1000);
+  gpio_set_function(PIN_SD_SCK, GPIO_FUNC_SPI);
+  gpio_set_function(PIN_SD_MOSI, GPIO_FUNC_SPI);
+  gpio_set_function(PIN_SD_MISO, GPIO_FUNC_SPI);
+  gpio_pull_up(PIN_SD_MISO);
+  gpio_init(PIN_SD_CS);
+  gpio_set_dir(PIN_SD_CS, GPIO_OUT);
+  gpio_put(PIN_SD_CS, 1);
+
+  // 74+ clocks with CS high to enter SPI mode.
+  for (int i = 0; i < 10; i++)
+    sd_xfer(0xff);
+
+  sd_select(true);
+
+  bool ok = false;
+
+  if (sd_command(0, 0) == 0x01) {
+    const bool v2 = sd_command(8, 0x1aa) == 0x01;
+    if (v2) {
+      for (int i = 0; i < 4; i++)
+        sd_xfer(0xff);
+    }
+
+    absolute_time_t timeout = make_timeout_time_ms(1000);
+    uint8_t r;
+    while ((r = sd_app_command(41, v2 ? 0x40000000 : 0)) != 0 &&
+           !time_reached(timeout))
+      ;
+
+    if (r == 0) {
+      sd_blockaddr = false;
+      if (v2 && sd_command(58, 0) == 0) {
+        sd_blockaddr = sd_xfer(0xff) & 0x40;
+        for (int i = 0; i < 3; i++)
+          sd_xfer(0xff);
+      }
+      ok = sd_blockaddr || sd_command(16, SD_SECTOR) == 0;
+    }
+  }
+
+  sd_select(false);
+
+  if (ok)
+    spi_set_baudrate(SD_SPI, 25 * 1000 * 1000);
+
+  return ok;
+}
+
+static bool sd_read_sector(uint32_t sector, uint8_t *dest) {
+  sd_select(true);
+
+  bool ok = false;
+
+  if (sd_command(17, sd_blockaddr ? sector : sector * SD_SECTOR) == 0) {
+    absolute_time_t timeout = make_timeout_time_ms(100);
+    uint8_t token;
+    while ((token = sd_xfer(0xff)) == 0xff && !time_reached(timeout))
+      ;
+
+    if (token == 0xfe) {
+      spi_read_blocking(SD_SPI, 0xff, dest, SD_SECTOR);
+      sd_xfer(0xff); // CRC
+      sd_xfer(0xff);
+      ok = true;
+    }
+  }
+
+  sd_select(false);
+  return ok;
+}
+
+int I_OpenWad_e32(void) {
+  if (!sd_init())
+    return 0;
+
+  uint8_t header[SD_SECTOR];
+  if (!sd_read_sector(0, header))
+    return 0;
+
+  // A PWAD alone loads on top of the built in IWAD.
+  return !memcmp(header, "IWAD", 4) || !memcmp(header, "PWAD", 4);
+}
+
+int I_ReadWad_e32(unsigned int offset, void *dest, int len) {
+  uint8_t *d = dest;
+  int done = 0;
+
+  while (done < len) {
+    const uint32_t sector = (offset + done) / SD_SECTOR;
+    const int skip = (offset + done) % SD_SECTOR;
+    int n = SD_SECTOR - skip;
+
+    if (n > len - done)
+      n = len - done;
+
+    if (n == SD_SECTOR) {
+      // Whole sectors go straight to the destination.
+      if (!sd_read_sector(sector, d + done))
+        break;
+    } else {
+      if (sector != sd_cached_sector) {
+        if (!sd_read_sector(sector, sd_sector))
+          break;
+        sd_cached_sector = sector;
+      }
+      memcpy(d + done, sd_sector + skip, n);
+    }
+
+    done += n;
+  }
+
+  return done;
+}
+
+#else
+
+int I_OpenWad_e32(void) { return 0; }
+
+int I_ReadWad_e32(unsigned int offset, void *dest, int len) { return 0; }
+
+#endif
+
+//**************************************************************************************
+
 #define MAX_MESSAGE_SIZE 1024
 
 void I_Error(const char *error, ...) {
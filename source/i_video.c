@@ -121,7 +121,7 @@ static void I_UploadNewPalette(int pal)
   
     if(!_g->pallete_lump)
     {
-        _g->pallete_lump = W_CacheLumpName("PLAYPAL");
+        _g->pallete_lump = W_CacheLumpNamePinned("PLAYPAL");
     }
 
     _g->current_pallete = &_g->pallete_lump[pal*256*3];
@@ -435,6 +435,10 @@ void M_DrawSaveLoadBorder(int x,int y)
     }
 
     V_DrawPatchNoScale(x, y+7, rpatch);
+
+    W_UnlockLumpName("M_LSLEFT");
+    W_UnlockLumpName("M_LSCNTR");
+    W_UnlockLumpName("M_LSRGHT");
 }
 
 //
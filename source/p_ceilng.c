@@ -279,7 +279,7 @@ int EV_DoCeiling
 
     // create a new ceiling thinker
     rtn = 1;
-    ceiling = Z_Malloc (sizeof(*ceiling), PU_LEVSPEC, 0);
+    ceiling = P_NewThinker(tp_ceiling);
     memset(ceiling, 0, sizeof(*ceiling));
     P_AddThinker (&ceiling->thinker);
     sec->ceilingdata = ceiling;               //jff 2/22/98
@@ -424,7 +424,7 @@ void P_AddActiveCeiling(ceiling_t* ceiling)
 {
     ceilinglist_t *old_head = _g->activeceilings;
 
-    ceilinglist_t *list = Z_Malloc(sizeof *list, PU_LEVEL, &_g->activeceilings);
+    ceilinglist_t *list = Z_Malloc(sizeof *list, PU_LEVSPEC, &_g->activeceilings);
     list->ceiling = ceiling;
     ceiling->list = list;
 
@@ -447,7 +447,7 @@ void P_RemoveActiveCeiling(ceiling_t* ceiling)
   ceilinglist_t *list = ceiling->list;
   ceiling->sector->ceilingdata = NULL;  //jff 2/22/98
 
-  P_RemoveThinker(&ceiling->thinker);
+  P_RemoveThinker(&ceiling->thinker, tp_ceiling);
 
   if ((list->prev && (*list->prev = list->next)))
     list->next->prev = list->prev;
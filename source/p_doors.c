@@ -152,7 +152,7 @@ void T_VerticalDoor (vldoor_t* door)
           case genBlazeRaise:
           case genBlazeClose:
             door->sector->ceilingdata = NULL;  //jff 2/22/98
-            P_RemoveThinker (&door->thinker);  // unlink and free
+            P_RemoveThinker (&door->thinker, tp_door);  // unlink and free
             // killough 4/15/98: remove double-closing sound of blazing doors
             break;
 
@@ -161,7 +161,7 @@ void T_VerticalDoor (vldoor_t* door)
           case genRaise:
           case genClose:
             door->sector->ceilingdata = NULL; //jff 2/22/98
-            P_RemoveThinker (&door->thinker);  // unlink and free
+            P_RemoveThinker (&door->thinker, tp_door);  // unlink and free
             break;
 
           // close then open doors start waiting
@@ -251,7 +251,7 @@ void T_VerticalDoor (vldoor_t* door)
           case genCdO:
           case genBlazeCdO:
             door->sector->ceilingdata = NULL; //jff 2/22/98
-            P_RemoveThinker (&door->thinker); // unlink and free
+            P_RemoveThinker (&door->thinker, tp_door); // unlink and free
             break;
 
           default:
@@ -358,7 +358,7 @@ int EV_DoDoor
 
     // new door thinker
     rtn = 1;
-    door = Z_Malloc (sizeof(*door), PU_LEVSPEC, 0);
+    door = P_NewThinker(tp_door);
     memset(door, 0, sizeof(*door));
     P_AddThinker (&door->thinker);
     sec->ceilingdata = door; //jff 2/22/98
@@ -567,7 +567,7 @@ int EV_VerticalDoor
   }
 
   // new door thinker
-  door = Z_Malloc (sizeof(*door), PU_LEVSPEC, 0);
+  door = P_NewThinker(tp_door);
   memset(door, 0, sizeof(*door));
   P_AddThinker (&door->thinker);
   sec->ceilingdata = door; //jff 2/22/98
@@ -639,7 +639,7 @@ void P_SpawnDoorCloseIn30 (sector_t* sec)
 {
   vldoor_t* door;
 
-  door = Z_Malloc ( sizeof(*door), PU_LEVSPEC, 0);
+  door = P_NewThinker(tp_door);
 
   memset(door, 0, sizeof(*door));
   P_AddThinker (&door->thinker);
@@ -671,7 +671,7 @@ void P_SpawnDoorRaiseIn5Mins
 {
   vldoor_t* door;
 
-  door = Z_Malloc ( sizeof(*door), PU_LEVSPEC, 0);
+  door = P_NewThinker(tp_door);
 
   memset(door, 0, sizeof(*door));
   P_AddThinker (&door->thinker);
@@ -78,46 +78,45 @@ void P_ZBumpCheck(mobj_t *);                                        // phares
 //
 
 //
-// Called by P_NoiseAlert.
-// Recursively traverse adjacent sectors,
-// sound blocking lines cut off traversal.
+// P_SoundNeighbours
+// Wakes the neighbours of one queued sector across sound blocking
+// lines or across the others, and queues them. Doors have to be
+// open, as P_LineOpening would say. Returns the new end of the queue.
 //
-// killough 5/5/98: reformatted, cleaned up
 
-static void P_RecursiveSound(sector_t *sec, int soundblocks,
-           mobj_t *soundtarget)
+static int P_SoundNeighbours(int from, int last, boolean soundblock,
+           int soundtraversed, mobj_t *soundtarget)
 {
-  int i;
+  unsigned short *queue = _g->soundqueue;
+  const sector_t *sec = &_g->sectors[queue[from]];
+  int e, end = _g->sectoredges[queue[from]+1];
 
-  // wake up all monsters in this sector
-  if (sec->validcount == _g->validcount && sec->soundtraversed <= soundblocks+1)
-    return;             // already flooded
-
-  sec->validcount = _g->validcount;
-  sec->soundtraversed = soundblocks+1;
-  P_SetTarget(&sec->soundtarget, soundtarget);
-
-  for (i=0; i<sec->linecount; i++)
+  for (e = _g->sectoredges[queue[from]]; e < end; e++)
     {
+      const unsigned int edge = _g->soundedges[e];
       sector_t *other;
-      const line_t *check = sec->lines[i];
 
-      if (!(check->flags & ML_TWOSIDED))
+      if (!(edge & SE_SOUNDBLOCK) != !soundblock)
         continue;
 
-      P_LineOpening(check);
+      other = &_g->sectors[edge & ~SE_SOUNDBLOCK];
+
+      if (other->validcount == _g->validcount)
+        continue;       // already flooded
 
-      if (_g->openrange <= 0)
+      if ((sec->ceilingheight < other->ceilingheight ? sec->ceilingheight : other->ceilingheight) <=
+          (sec->floorheight > other->floorheight ? sec->floorheight : other->floorheight))
         continue;       // closed door
 
-      other=_g->sides[check->sidenum[_g->sides[check->sidenum[0]].sector==sec]].sector;
+      // wake up all monsters in this sector
+      other->validcount = _g->validcount;
+      other->soundtraversed = soundtraversed;
+      P_SetTarget(&other->soundtarget, soundtarget);
 
-      if (!(check->flags & ML_SOUNDBLOCK))
-        P_RecursiveSound(other, soundblocks, soundtarget);
-      else
-        if (!soundblocks)
-          P_RecursiveSound(other, 1, soundtarget);
+      queue[last++] = edge & ~SE_SOUNDBLOCK;
     }
+
+  return last;
 }
 
 //
@@ -125,10 +124,35 @@ static void P_RecursiveSound(sector_t *sec, int soundblocks,
 // If a monster yells at a player,
 // it will alert other monsters to the player.
 //
+// Sound spreads through open two sided lines and can cross at most
+// one sound blocking line. Rather than recurse, the sectors it
+// reaches without crossing one are flooded first, then the ones
+// just past a blocking line and what those reach. Each sector is
+// queued once, and ends up just as the old recursive flood left it.
+//
 void P_NoiseAlert(mobj_t *target, mobj_t *emitter)
 {
+  sector_t *sec = emitter->subsector->sector;
+  int i, first, end, last = 1;
+
   _g->validcount++;
-  P_RecursiveSound(emitter->subsector->sector, 0, target);
+
+  sec->validcount = _g->validcount;
+  sec->soundtraversed = 1;
+  P_SetTarget(&sec->soundtarget, target);
+
+  _g->soundqueue[0] = sec - _g->sectors;
+
+  // Everything reached without crossing a sound blocking line...
+  for (first = 0; first < last; first++)
+    last = P_SoundNeighbours(first, last, false, 1, target);
+
+  // ...then one blocking line further, and on from there.
+  for (i = 0, end = last; i < end; i++)
+    last = P_SoundNeighbours(i, last, true, 2, target);
+
+  for (; first < last; first++)
+    last = P_SoundNeighbours(first, last, false, 2, target);
 }
 
 //
@@ -277,7 +301,7 @@ static int P_IsUnderDamage(mobj_t *actor)
   const struct msecnode_s *seclist;
   const ceiling_t *cl;             // Crushing ceiling
   int dir = 0;
-  for (seclist=actor->touching_sectorlist; seclist; seclist=seclist->m_tnext)
+  for (seclist=P_MobjCold(actor)->touching_sectorlist; seclist; seclist=seclist->m_tnext)
     if ((cl = seclist->m_sector->ceilingdata) &&
   cl->thinker.function == T_MoveCeiling)
       dir |= cl->direction;
@@ -295,22 +319,23 @@ static const fixed_t yspeed[8] = {0,47000,FRACUNIT,47000,0,-47000,-FRACUNIT,-470
 
 static boolean P_Move(mobj_t *actor, boolean dropoff) /* killough 9/12/98 */
 {
+  mobjcold_t *cold = P_MobjCold(actor);
   fixed_t tryx, tryy, deltax, deltay, origx, origy;
   boolean try_ok;
   int speed;
 
-  if (actor->movedir == DI_NODIR)
+  if (cold->movedir == DI_NODIR)
     return false;
 
 #ifdef RANGECHECK
-  if ((unsigned)actor->movedir >= 8)
+  if ((unsigned)cold->movedir >= 8)
     I_Error ("P_Move: Weird actor->movedir!");
 #endif
 
   speed = mobjinfo[actor->type].speed;
 
-  tryx = (origx = actor->x) + (deltax = speed * xspeed[actor->movedir]);
-  tryy = (origy = actor->y) + (deltay = speed * yspeed[actor->movedir]);
+  tryx = (origx = actor->x) + (deltax = speed * xspeed[cold->movedir]);
+  tryy = (origy = actor->y) + (deltay = speed * yspeed[cold->movedir]);
 
   try_ok = P_TryMove(actor, tryx, tryy, dropoff);
 
@@ -333,7 +358,7 @@ static boolean P_Move(mobj_t *actor, boolean dropoff) /* killough 9/12/98 */
       if (!_g->numspechit)
         return false;
 
-      actor->movedir = DI_NODIR;
+      cold->movedir = DI_NODIR;
 
       /* if the special is not a door that can be opened, return false
        *
@@ -406,7 +431,7 @@ static boolean P_SmartMove(mobj_t *actor)
        (under_damage = P_IsUnderDamage(actor)) &&
        (under_damage < 0 || P_Random() < 200))
       )
-    actor->movedir = DI_NODIR;    // avoid the area (most of the time anyway)
+    P_MobjCold(actor)->movedir = DI_NODIR;    // avoid the area (most of the time anyway)
 
   return true;
 }
@@ -442,8 +467,9 @@ static boolean P_TryWalk(mobj_t *actor)
 
 static void P_DoNewChaseDir(mobj_t *actor, fixed_t deltax, fixed_t deltay)
 {
+  mobjcold_t *cold = P_MobjCold(actor);
   int xdir, ydir, tdir;
-  int olddir = actor->movedir;
+  int olddir = cold->movedir;
   int turnaround = olddir;
 
   if (turnaround != DI_NODIR)         // find reverse direction
@@ -459,7 +485,7 @@ static void P_DoNewChaseDir(mobj_t *actor, fixed_t deltax, fixed_t deltay)
 
   // try direct route
   if (xdir != DI_NODIR && ydir != DI_NODIR && turnaround !=
-      (actor->movedir = deltay < 0 ? deltax > 0 ? DI_SOUTHEAST : DI_SOUTHWEST :
+      (cold->movedir = deltay < 0 ? deltax > 0 ? DI_SOUTHEAST : DI_SOUTHWEST :
        deltax > 0 ? DI_NORTHEAST : DI_NORTHWEST) && P_TryWalk(actor))
     return;
 
@@ -468,33 +494,33 @@ static void P_DoNewChaseDir(mobj_t *actor, fixed_t deltax, fixed_t deltay)
     tdir = xdir, xdir = ydir, ydir = tdir;
 
   if ((xdir == turnaround ? xdir = DI_NODIR : xdir) != DI_NODIR &&
-      (actor->movedir = xdir, P_TryWalk(actor)))
+      (cold->movedir = xdir, P_TryWalk(actor)))
     return;         // either moved forward or attacked
 
   if ((ydir == turnaround ? ydir = DI_NODIR : ydir) != DI_NODIR &&
-      (actor->movedir = ydir, P_TryWalk(actor)))
+      (cold->movedir = ydir, P_TryWalk(actor)))
     return;
 
   // there is no direct path to the player, so pick another direction.
-  if (olddir != DI_NODIR && (actor->movedir = olddir, P_TryWalk(actor)))
+  if (olddir != DI_NODIR && (cold->movedir = olddir, P_TryWalk(actor)))
     return;
 
   // randomly determine direction of search
   if (P_Random() & 1)
   {
       for (tdir = DI_EAST; tdir <= DI_SOUTHEAST; tdir++)
-          if (tdir != turnaround && (actor->movedir = tdir, P_TryWalk(actor)))
+          if (tdir != turnaround && (cold->movedir = tdir, P_TryWalk(actor)))
               return;
   }
   else
   {
       for (tdir = DI_SOUTHEAST; tdir >= DI_EAST; tdir--)
-          if (tdir != turnaround && (actor->movedir = tdir, P_TryWalk(actor)))
+          if (tdir != turnaround && (cold->movedir = tdir, P_TryWalk(actor)))
               return;
   }
 
-  if ((actor->movedir = turnaround) != DI_NODIR && !P_TryWalk(actor))
-    actor->movedir = DI_NODIR;
+  if ((cold->movedir = turnaround) != DI_NODIR && !P_TryWalk(actor))
+    cold->movedir = DI_NODIR;
 }
 
 //
@@ -584,7 +610,7 @@ static void P_NewChaseDir(mobj_t *actor)
     // 1) Stay a certain distance away from a friend, to avoid being in their way
     // 2) Take advantage over an enemy without missiles, by keeping distance
 
-    if (actor->floorz - actor->dropoffz > FRACUNIT*24 &&
+    if (actor->floorz - P_MobjCold(actor)->dropoffz > FRACUNIT*24 &&
             actor->z <= actor->floorz &&
             !(actor->flags & (MF_DROPOFF|MF_FLOAT)) &&
             P_AvoidDropoff(actor)) /* Move away from dropoff */
@@ -665,7 +691,7 @@ static boolean P_LookForPlayers(mobj_t *actor, boolean allaround)
         /* killough 9/9/98: give monsters a threshold towards getting players
        * (we don't want it to be too easy for a player with dogs :)
        */
-        actor->threshold = 60;
+        P_MobjCold(actor)->threshold = 60;
 
         return true;
     }
@@ -725,14 +751,14 @@ void A_KeenDie(mobj_t* mo)
 void A_Look(mobj_t *actor)
 {
     mobj_t *targ = actor->subsector->sector->soundtarget;
-    actor->threshold = 0; // any shot will wake up
+    P_MobjCold(actor)->threshold = 0; // any shot will wake up
 
     /* killough 7/18/98:
    * Friendly monsters go after other monsters first, but
    * also return to player, without attacking them, if they
    * cannot find any targets. A marine's best friend :)
    */
-    actor->pursuecount = 0;
+    P_MobjCold(actor)->pursuecount = 0;
 
     boolean seen = false;
 
@@ -802,24 +828,26 @@ void A_Look(mobj_t *actor)
 
 void A_Chase(mobj_t *actor)
 {
+    mobjcold_t *cold = P_MobjCold(actor);
+
     if (actor->reactiontime)
         actor->reactiontime--;
 
-    if (actor->threshold)
+    if (cold->threshold)
     { /* modify target threshold */
         if (!actor->target || actor->target->health <= 0)
-            actor->threshold = 0;
+            cold->threshold = 0;
         else
-            actor->threshold--;
+            cold->threshold--;
     }
 
     /* turn towards movement direction if not there yet
    * killough 9/7/98: keep facing towards target if strafing or backing out
    */
 
-    if (actor->movedir < 8)
+    if (cold->movedir < 8)
     {
-        int delta = (actor->angle &= (7<<29)) - (actor->movedir << 29);
+        int delta = (actor->angle &= (7<<29)) - (cold->movedir << 29);
         if (delta > 0)
             actor->angle -= ANG90/2;
         else
@@ -872,15 +900,15 @@ void A_Chase(mobj_t *actor)
     }
 
 
-    if (!actor->threshold)
+    if (!cold->threshold)
     {
-        if (actor->pursuecount)
-            actor->pursuecount--;
+        if (cold->pursuecount)
+            cold->pursuecount--;
         else
         {
             /* Our pursuit time has expired. We're going to think about
              * changing targets */
-            actor->pursuecount = BASETHRESHOLD;
+            cold->pursuecount = BASETHRESHOLD;
 
           /* Unless (we have a live target
            *         and it's not friendly
@@ -968,6 +996,7 @@ void A_SPosAttack(mobj_t* actor)
   S_StartSound(actor, sfx_shotgn);
   A_FaceTarget(actor);
   bangle = actor->angle;
+  P_StartFan();
   slope = P_AimLineAttack(actor, bangle, MISSILERANGE, 0); /* killough 8/2/98 */
   for (i=0; i<3; i++)
     {  // killough 5/5/98: remove dependence on order of evaluation:
@@ -976,6 +1005,7 @@ void A_SPosAttack(mobj_t* actor)
       int damage = ((P_Random()%5)+1)*3;
       P_LineAttack(actor, angle, MISSILERANGE, slope, damage);
     }
+  P_EndFan();
 }
 
 void A_CPosAttack(mobj_t *actor)
@@ -1133,7 +1163,7 @@ void A_SkelMissile(mobj_t *actor)
 
   mo->x += mo->momx;
   mo->y += mo->momy;
-  P_SetTarget(&mo->tracer, actor->target);
+  P_SetTarget(&P_MobjCold(mo)->tracer, actor->target);
 }
 
 static const int TRACEANGLE = 0xc000000;
@@ -1177,7 +1207,7 @@ void A_Tracer(mobj_t *actor)
     th->tics = 1;
 
   // adjust direction
-  dest = actor->tracer;
+  dest = P_MobjCold(actor)->tracer;
 
   if (!dest || dest->health <= 0)
     return;
@@ -1312,18 +1342,18 @@ void A_VileChase(mobj_t* actor)
     int yl, yh;
     int bx, by;
 
-    if (actor->movedir != DI_NODIR)
+    if (P_MobjCold(actor)->movedir != DI_NODIR)
     {
         // check for corpses to raise
         _g->viletryx =
-                actor->x + mobjinfo[actor->type].speed*xspeed[actor->movedir];
+                actor->x + mobjinfo[actor->type].speed*xspeed[P_MobjCold(actor)->movedir];
         _g->viletryy =
-                actor->y + mobjinfo[actor->type].speed*yspeed[actor->movedir];
+                actor->y + mobjinfo[actor->type].speed*yspeed[P_MobjCold(actor)->movedir];
 
-        xl = (_g->viletryx - _g->bmaporgx - MAXRADIUS*2)>>MAPBLOCKSHIFT;
-        xh = (_g->viletryx - _g->bmaporgx + MAXRADIUS*2)>>MAPBLOCKSHIFT;
-        yl = (_g->viletryy - _g->bmaporgy - MAXRADIUS*2)>>MAPBLOCKSHIFT;
-        yh = (_g->viletryy - _g->bmaporgy + MAXRADIUS*2)>>MAPBLOCKSHIFT;
+        xl = (_g->viletryx - _g->bmaporgx - MAXRADIUS*2)>>THINGBLOCKSHIFT;
+        xh = (_g->viletryx - _g->bmaporgx + MAXRADIUS*2)>>THINGBLOCKSHIFT;
+        yl = (_g->viletryy - _g->bmaporgy - MAXRADIUS*2)>>THINGBLOCKSHIFT;
+        yh = (_g->viletryy - _g->bmaporgy + MAXRADIUS*2)>>THINGBLOCKSHIFT;
 
         for (bx=xl ; bx<=xh ; bx++)
         {
@@ -1355,7 +1385,8 @@ void A_VileChase(mobj_t* actor)
                     * friendliness is transferred from AV to raised corpse
                     */
                     _g->corpsehit->flags =
-                            (info->flags & ~MF_FRIEND) | (actor->flags & MF_FRIEND);
+                            (info->flags & ~MF_FRIEND) | (actor->flags & MF_FRIEND) |
+                            (_g->corpsehit->flags & MF_DORMANT);
 
                     if (!((_g->corpsehit->flags ^ MF_COUNTKILL) & (MF_FRIEND | MF_COUNTKILL)))
                         _g->totallive++;
@@ -1364,7 +1395,7 @@ void A_VileChase(mobj_t* actor)
                     P_SetTarget(&_g->corpsehit->target, NULL);  // killough 11/98
 
 
-                    P_SetTarget(&_g->corpsehit->lastenemy, NULL);
+                    P_SetTarget(&P_MobjCold(_g->corpsehit)->lastenemy, NULL);
                     _g->corpsehit->flags &= ~MF_JUSTHIT;
 
 
@@ -1405,7 +1436,7 @@ void A_FireCrackle(mobj_t* actor)
 void A_Fire(mobj_t *actor)
 {
   unsigned an;
-  mobj_t *dest = actor->tracer;
+  mobj_t *dest = P_MobjCold(actor)->tracer;
 
   if (!dest)
     return;
@@ -1440,9 +1471,9 @@ void A_VileTarget(mobj_t *actor)
   // killough 12/98: fix Vile fog coordinates // CPhipps - compatibility optioned
   fog = P_SpawnMobj(actor->target->x, actor->target->y, actor->target->z,MT_FIRE);
 
-  P_SetTarget(&actor->tracer, fog);
+  P_SetTarget(&P_MobjCold(actor)->tracer, fog);
   P_SetTarget(&fog->target, actor);
-  P_SetTarget(&fog->tracer, actor->target);
+  P_SetTarget(&P_MobjCold(fog)->tracer, actor->target);
   A_Fire(fog);
 }
 
@@ -1469,7 +1500,7 @@ void A_VileAttack(mobj_t *actor)
 
   an = actor->angle >> ANGLETOFINESHIFT;
 
-  fire = actor->tracer;
+  fire = P_MobjCold(actor)->tracer;
 
   if (!fire)
     return;
@@ -77,6 +77,9 @@ result_e T_MovePlane
   fixed_t       destheight; //jff 02/04/98 used to keep floors/ceilings
                             // from moving thru each other
 
+  // Any sector height change can open or block a line of sight.
+  _g->sightversion++;
+
   switch(floorOrCeiling)
   {
     case 0:
@@ -290,7 +293,7 @@ void T_MoveFloor(floormove_t* floor)
     }
 
     floor->sector->floordata = NULL; //jff 2/22/98
-    P_RemoveThinker(&floor->thinker);//remove this floor from list of movers
+    P_RemoveThinker(&floor->thinker, tp_floor);//remove this floor from list of movers
 
     // make floor stop sound
     S_StartSound2(&floor->sector->soundorg, sfx_pstop);
@@ -366,7 +369,7 @@ void T_MoveElevator(elevator_t* elevator)
   {
     elevator->sector->floordata = NULL;     //jff 2/22/98
     elevator->sector->ceilingdata = NULL;   //jff 2/22/98
-    P_RemoveThinker(&elevator->thinker);    // remove elevator from actives
+    P_RemoveThinker(&elevator->thinker, tp_elevator);    // remove elevator from actives
 
     // make floor stop sound
     S_StartSound2(&elevator->sector->soundorg, sfx_pstop);
@@ -410,7 +413,7 @@ int EV_DoFloor
 
     // new floor thinker
     rtn = 1;
-    floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+    floor = P_NewThinker(tp_floor);
     memset(floor, 0, sizeof(*floor));
     P_AddThinker (&floor->thinker);
     sec->floordata = floor; //jff 2/22/98
@@ -710,7 +713,7 @@ int EV_BuildStairs
 
     // create new floor thinker for first step
     rtn = 1;
-    floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+    floor = P_NewThinker(tp_floor);
     memset(floor, 0, sizeof(*floor));
     P_AddThinker (&floor->thinker);
     sec->floordata = floor;
@@ -779,7 +782,7 @@ int EV_BuildStairs
         secnum = newsecnum;
 
         // create and initialize a thinker for the next step
-        floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+        floor = P_NewThinker(tp_floor);
         memset(floor, 0, sizeof(*floor));
         P_AddThinker (&floor->thinker);
 
@@ -854,7 +857,7 @@ int EV_DoDonut(const line_t*  line)
       s3 = LN_BACKSECTOR((s2->lines[i]));      // s3 is model sector for changes
 
       //  Spawn rising slime
-      floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+      floor = P_NewThinker(tp_floor);
       memset(floor, 0, sizeof(*floor));
       P_AddThinker (&floor->thinker);
       s2->floordata = floor; //jff 2/22/98
@@ -869,7 +872,7 @@ int EV_DoDonut(const line_t*  line)
       floor->floordestheight = s3->floorheight;
 
       //  Spawn lowering donut-hole pillar
-      floor = Z_Malloc (sizeof(*floor), PU_LEVSPEC, 0);
+      floor = P_NewThinker(tp_floor);
       memset(floor, 0, sizeof(*floor));
       P_AddThinker (&floor->thinker);
       s1->floordata = floor; //jff 2/22/98
@@ -917,7 +920,7 @@ int EV_DoElevator
 
     // create and initialize new elevator thinker
     rtn = 1;
-    elevator = Z_Malloc (sizeof(*elevator), PU_LEVSPEC, 0);
+    elevator = P_NewThinker(tp_elevator);
     memset(elevator, 0, sizeof(*elevator));
     P_AddThinker (&elevator->thinker);
     sec->floordata = elevator; //jff 2/22/98
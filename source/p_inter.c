@@ -696,6 +696,9 @@ void P_DamageMobj(mobj_t *target,mobj_t *inflictor, mobj_t *source, int damage)
   if (target->health <= 0)
     return;
 
+  if (target->flags & MF_DORMANT)
+    P_WakeThing(target);
+
   if (target->flags & MF_SKULLFLY)
     target->momx = target->momy = target->momz = 0;
 
@@ -796,7 +799,7 @@ void P_DamageMobj(mobj_t *target,mobj_t *inflictor, mobj_t *source, int damage)
   /* killough 9/9/98: cleaned up, made more consistent: */
 
   if (source && source != target && source->type != MT_VILE &&
-      (!target->threshold || target->type == MT_VILE))
+      (!P_MobjCold(target)->threshold || target->type == MT_VILE))
     {
       /* if not intent on another player, chase after this one
        *
@@ -805,14 +808,14 @@ void P_DamageMobj(mobj_t *target,mobj_t *inflictor, mobj_t *source, int damage)
        * killough 9/9/98: cleaned up, made more consistent:
        */
 
-      if (!target->lastenemy || target->lastenemy->health <= 0 ||
+      if (!P_MobjCold(target)->lastenemy || P_MobjCold(target)->lastenemy->health <= 0 ||
     (
-     !((target->flags ^ target->lastenemy->flags) & MF_FRIEND) &&
+     !((target->flags ^ P_MobjCold(target)->lastenemy->flags) & MF_FRIEND) &&
      target->target != source)) // remember last enemy - killough
-  P_SetTarget(&target->lastenemy, target->target);
+  P_SetTarget(&P_MobjCold(target)->lastenemy, target->target);
 
       P_SetTarget(&target->target, source);       // killough 11/98
-      target->threshold = BASETHRESHOLD;
+      P_MobjCold(target)->threshold = BASETHRESHOLD;
       if (target->state == &states[mobjinfo[target->type].spawnstate]
           && mobjinfo[target->type].seestate != S_NULL)
         P_SetMobjState (target, mobjinfo[target->type].seestate);
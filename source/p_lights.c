@@ -100,62 +100,70 @@ void T_LightFlash (lightflash_t* flash)
 }
 
 //
-// T_StrobeFlash()
+// T_StrobeFlashes()
 //
 // Strobe light flashing action routine, called once per tick
+// for the whole batch of strobes
 //
-// Passed a strobe_t structure containing light levels and timing
+// Passed the dense array of strobe_t structures and its length
 // Returns nothing
 //
-void T_StrobeFlash (strobe_t*   flash)
+void T_StrobeFlashes (strobe_t*   flash, unsigned int count)
 {
-  if (--flash->count)
-    return;
-
-  if (flash->sector->lightlevel == flash->minlight)
+  for (; count--; flash++)
   {
-    flash-> sector->lightlevel = flash->maxlight;
-    flash->count = flash->brighttime;
-  }
-  else
-  {
-    flash-> sector->lightlevel = flash->minlight;
-    flash->count =flash->darktime;
+    if (--flash->count)
+      continue;
+
+    if (flash->sector->lightlevel == flash->minlight)
+    {
+      flash-> sector->lightlevel = flash->maxlight;
+      flash->count = flash->brighttime;
+    }
+    else
+    {
+      flash-> sector->lightlevel = flash->minlight;
+      flash->count =flash->darktime;
+    }
   }
 }
 
 //
-// T_Glow()
+// T_Glows()
 //
 // Glowing light action routine, called once per tick
+// for the whole batch of glows
 //
-// Passed a glow_t structure containing light levels and timing
+// Passed the dense array of glow_t structures and its length
 // Returns nothing
 //
 
-void T_Glow(glow_t* g)
+void T_Glows(glow_t* g, unsigned int count)
 {
-  switch(g->direction)
+  for (; count--; g++)
   {
-    case -1:
-      // light dims
-      g->sector->lightlevel -= GLOWSPEED;
-      if (g->sector->lightlevel <= g->minlight)
-      {
-        g->sector->lightlevel += GLOWSPEED;
-        g->direction = 1;
-      }
-      break;
-
-    case 1:
-      // light brightens
-      g->sector->lightlevel += GLOWSPEED;
-      if (g->sector->lightlevel >= g->maxlight)
-      {
+    switch(g->direction)
+    {
+      case -1:
+        // light dims
         g->sector->lightlevel -= GLOWSPEED;
-        g->direction = -1;
-      }
-      break;
+        if (g->sector->lightlevel <= g->minlight)
+        {
+          g->sector->lightlevel += GLOWSPEED;
+          g->direction = 1;
+        }
+        break;
+
+      case 1:
+        // light brightens
+        g->sector->lightlevel += GLOWSPEED;
+        if (g->sector->lightlevel >= g->maxlight)
+        {
+          g->sector->lightlevel -= GLOWSPEED;
+          g->direction = -1;
+        }
+        break;
+    }
   }
 }
 
@@ -184,7 +192,7 @@ void P_SpawnFireFlicker (sector_t*  sector)
   // Nothing special about it during gameplay.
   sector->special &= ~31; //jff 3/14/98 clear non-generalized sector type
 
-  flick = Z_Malloc ( sizeof(*flick), PU_LEVSPEC, 0);
+  flick = P_NewThinker(tp_fireflicker);
 
   memset(flick, 0, sizeof(*flick));
   P_AddThinker (&flick->thinker);
@@ -211,7 +219,7 @@ void P_SpawnLightFlash (sector_t* sector)
   // nothing special about it during gameplay
   sector->special &= ~31; //jff 3/14/98 clear non-generalized sector type
 
-  flash = Z_Malloc ( sizeof(*flash), PU_LEVSPEC, 0);
+  flash = P_NewThinker(tp_lightflash);
 
   memset(flash, 0, sizeof(*flash));
   P_AddThinker (&flash->thinker);
@@ -243,15 +251,11 @@ void P_SpawnStrobeFlash
 {
   strobe_t* flash;
 
-  flash = Z_Malloc ( sizeof(*flash), PU_LEVSPEC, 0);
-
-  memset(flash, 0, sizeof(*flash));
-  P_AddThinker (&flash->thinker);
+  flash = P_NewBatchThinker(tb_strobe);
 
   flash->sector = sector;
   flash->darktime = fastOrSlow;
   flash->brighttime = STROBEBRIGHT;
-  flash->thinker.function = T_StrobeFlash;
   flash->maxlight = sector->lightlevel;
   flash->minlight = P_FindMinSurroundingLight(sector, sector->lightlevel);
 
@@ -279,15 +283,11 @@ void P_SpawnGlowingLight(sector_t*  sector)
 {
   glow_t* g;
 
-  g = Z_Malloc( sizeof(*g), PU_LEVSPEC, 0);
-
-  memset(g, 0, sizeof(*g));
-  P_AddThinker(&g->thinker);
+  g = P_NewBatchThinker(tb_glow);
 
   g->sector = sector;
   g->minlight = P_FindMinSurroundingLight(sector,sector->lightlevel);
   g->maxlight = sector->lightlevel;
-  g->thinker.function = T_Glow;
   g->direction = -1;
 
   sector->special &= ~31; //jff 3/14/98 clear non-generalized sector type
@@ -135,10 +135,10 @@ boolean P_TeleportMove (mobj_t* thing,fixed_t x,fixed_t y, boolean boss)
 
   // stomp on any things contacted
 
-  xl = (_g->tmbbox[BOXLEFT] - _g->bmaporgx - MAXRADIUS)>>MAPBLOCKSHIFT;
-  xh = (_g->tmbbox[BOXRIGHT] - _g->bmaporgx + MAXRADIUS)>>MAPBLOCKSHIFT;
-  yl = (_g->tmbbox[BOXBOTTOM] - _g->bmaporgy - MAXRADIUS)>>MAPBLOCKSHIFT;
-  yh = (_g->tmbbox[BOXTOP] - _g->bmaporgy + MAXRADIUS)>>MAPBLOCKSHIFT;
+  xl = (_g->tmbbox[BOXLEFT] - _g->bmaporgx - MAXRADIUS)>>THINGBLOCKSHIFT;
+  xh = (_g->tmbbox[BOXRIGHT] - _g->bmaporgx + MAXRADIUS)>>THINGBLOCKSHIFT;
+  yl = (_g->tmbbox[BOXBOTTOM] - _g->bmaporgy - MAXRADIUS)>>THINGBLOCKSHIFT;
+  yh = (_g->tmbbox[BOXTOP] - _g->bmaporgy + MAXRADIUS)>>THINGBLOCKSHIFT;
 
   for (bx=xl ; bx<=xh ; bx++)
     for (by=yl ; by<=yh ; by++)
@@ -152,7 +152,7 @@ boolean P_TeleportMove (mobj_t* thing,fixed_t x,fixed_t y, boolean boss)
 
   thing->floorz = _g->tmfloorz;
   thing->ceilingz = _g->tmceilingz;
-  thing->dropoffz = _g->tmdropoffz;        // killough 11/98
+  P_MobjCold(thing)->dropoffz = _g->tmdropoffz;        // killough 11/98
 
   thing->x = x;
   thing->y = y;
@@ -548,10 +548,10 @@ boolean P_CheckPosition (mobj_t* thing,fixed_t x,fixed_t y)
   // based on their origin point, and can overlap
   // into adjacent blocks by up to MAXRADIUS units.
 
-  xl = (_g->tmbbox[BOXLEFT] - _g->bmaporgx - MAXRADIUS)>>MAPBLOCKSHIFT;
-  xh = (_g->tmbbox[BOXRIGHT] - _g->bmaporgx + MAXRADIUS)>>MAPBLOCKSHIFT;
-  yl = (_g->tmbbox[BOXBOTTOM] - _g->bmaporgy - MAXRADIUS)>>MAPBLOCKSHIFT;
-  yh = (_g->tmbbox[BOXTOP] - _g->bmaporgy + MAXRADIUS)>>MAPBLOCKSHIFT;
+  xl = (_g->tmbbox[BOXLEFT] - _g->bmaporgx - MAXRADIUS)>>THINGBLOCKSHIFT;
+  xh = (_g->tmbbox[BOXRIGHT] - _g->bmaporgx + MAXRADIUS)>>THINGBLOCKSHIFT;
+  yl = (_g->tmbbox[BOXBOTTOM] - _g->bmaporgy - MAXRADIUS)>>THINGBLOCKSHIFT;
+  yh = (_g->tmbbox[BOXTOP] - _g->bmaporgy + MAXRADIUS)>>THINGBLOCKSHIFT;
 
 
   for (bx=xl ; bx<=xh ; bx++)
@@ -638,7 +638,7 @@ boolean P_TryMove(mobj_t* thing,fixed_t x,fixed_t y,
     oldy = thing->y;
     thing->floorz = _g->tmfloorz;
     thing->ceilingz = _g->tmceilingz;
-    thing->dropoffz = _g->tmdropoffz;      // killough 11/98: keep track of dropoffs
+    P_MobjCold(thing)->dropoffz = _g->tmdropoffz;      // killough 11/98: keep track of dropoffs
     thing->x = x;
     thing->y = y;
 
@@ -684,7 +684,7 @@ boolean P_ThingHeightClip (mobj_t* thing)
 
   thing->floorz = _g->tmfloorz;
   thing->ceilingz = _g->tmceilingz;
-  thing->dropoffz = _g->tmdropoffz;    /* killough 11/98: remember dropoffs */
+  P_MobjCold(thing)->dropoffz = _g->tmdropoffz;    /* killough 11/98: remember dropoffs */
 
   if (onfloor)
     {
@@ -1022,12 +1022,6 @@ boolean PTR_AimTraverse (intercept_t* in)
     if (!(th->flags&MF_SHOOTABLE))
         return true;    // corpse or something
 
-    /* killough 7/19/98, 8/2/98:
-   * friends don't aim at friends (except players), at least not first
-   */
-    if (th->flags & _g->shootthing->flags & _g->aim_flags_mask && !P_MobjIsPlayer(th))
-        return true;
-
     // check angles to see if the thing can be aimed at
 
     dist = FixedMul (_g->attackrange, in->frac);
@@ -1049,6 +1043,21 @@ boolean PTR_AimTraverse (intercept_t* in)
     if (thingbottomslope < _g->bottomslope)
         thingbottomslope = _g->bottomslope;
 
+    /* killough 7/19/98, 8/2/98:
+   * friends don't aim at friends (except players), at least not first
+   */
+    if (th->flags & _g->shootthing->flags & _g->aim_flags_mask && !P_MobjIsPlayer(th))
+    {
+        // Without the mask the trace would have stopped here.
+        if (!_g->aimfallback)
+        {
+            _g->aimfallback = th;
+            _g->aimfallbackslope = (thingtopslope+thingbottomslope)/2;
+        }
+
+        return true;
+    }
+
     _g->aimslope = (thingtopslope+thingbottomslope)/2;
     _g->linetarget = th;
 
@@ -1197,6 +1206,7 @@ fixed_t P_AimLineAttack(mobj_t* t1,angle_t angle,fixed_t distance, uint_64_t mas
 
   _g->attackrange = distance;
   _g->linetarget = NULL;
+  _g->aimfallback = NULL;
 
   /* killough 8/2/98: prevent friends from aiming at friends */
   _g->aim_flags_mask = mask;
@@ -1209,6 +1219,23 @@ fixed_t P_AimLineAttack(mobj_t* t1,angle_t angle,fixed_t distance, uint_64_t mas
   return 0;
   }
 
+//
+// P_AimFallback
+// What P_AimLineAttack with no mask returns for the trace the last
+// P_AimLineAttack just made, without walking it again. Everything up
+// to the thing the mask passed over is the same for both, so the
+// answer is too. Only good until anything moves, dies or spawns.
+//
+fixed_t P_AimFallback(void)
+  {
+  _g->linetarget = _g->aimfallback;
+
+  if (_g->linetarget)
+    return _g->aimslope = _g->aimfallbackslope;
+
+  return 0;
+  }
+
 
 //
 // P_LineAttack
@@ -1412,10 +1439,10 @@ void P_RadiusAttack(mobj_t* spot,mobj_t* source,int damage)
   fixed_t dist;
 
   dist = (damage+MAXRADIUS)<<FRACBITS;
-  yh = (spot->y + dist - _g->bmaporgy)>>MAPBLOCKSHIFT;
-  yl = (spot->y - dist - _g->bmaporgy)>>MAPBLOCKSHIFT;
-  xh = (spot->x + dist - _g->bmaporgx)>>MAPBLOCKSHIFT;
-  xl = (spot->x - dist - _g->bmaporgx)>>MAPBLOCKSHIFT;
+  yh = (spot->y + dist - _g->bmaporgy)>>THINGBLOCKSHIFT;
+  yl = (spot->y - dist - _g->bmaporgy)>>THINGBLOCKSHIFT;
+  xh = (spot->x + dist - _g->bmaporgx)>>THINGBLOCKSHIFT;
+  xl = (spot->x - dist - _g->bmaporgx)>>THINGBLOCKSHIFT;
   _g->bombspot = spot;
   _g->bombsource = source;
   _g->bombdamage = damage;
@@ -1452,7 +1479,13 @@ boolean PIT_ChangeSector (mobj_t* thing)
   mobj_t* mo;
 
   if (P_ThingHeightClip (thing))
+    {
+    // a dormant body left above the floor has to fall again
+    if (thing->flags & MF_DORMANT && thing->z != thing->floorz &&
+        !(thing->flags & MF_NOGRAVITY))
+      P_WakeThing(thing);
     return true; // keep checking
+    }
 
   // crunch bodies to giblets
 
@@ -40,6 +40,7 @@
 #include "p_maputl.h"
 #include "p_map.h"
 #include "p_setup.h"
+#include "lprintf.h"
 
 #include "global_data.h"
 
@@ -202,6 +203,8 @@ void P_LineOpening(const line_t *linedef)
 
 void P_UnsetThingPosition (mobj_t *thing)
 {
+  mobjcold_t *cold = P_MobjCold(thing);
+
   if (!(thing->flags & MF_NOSECTOR))
     {
       /* invisible things don't need to be in sector list
@@ -211,10 +214,10 @@ void P_UnsetThingPosition (mobj_t *thing)
        * pointers, allows head node pointers to be treated like everything else
        */
 
-      mobj_t **sprev = thing->sprev;
+      mobj_t **sprev = cold->sprev;
       mobj_t  *snext = thing->snext;
       if ((*sprev = snext))  // unlink from sector list
-        snext->sprev = sprev;
+        P_MobjCold(snext)->sprev = sprev;
 
         // phares 3/14/98
         //
@@ -229,8 +232,8 @@ void P_UnsetThingPosition (mobj_t *thing)
         // If this Thing is being removed entirely, then the calling
         // routine will clear out the nodes in sector_list.
 
-      _g->sector_list = thing->touching_sectorlist;
-      thing->touching_sectorlist = NULL; //to be restored by P_SetThingPosition
+      _g->sector_list = cold->touching_sectorlist;
+      cold->touching_sectorlist = NULL; //to be restored by P_SetThingPosition
     }
 
   if (!(thing->flags & MF_NOBLOCKMAP))
@@ -246,9 +249,9 @@ void P_UnsetThingPosition (mobj_t *thing)
        * linking.
        */
 
-      mobj_t *bnext, **bprev = thing->bprev;
+      mobj_t *bnext, **bprev = cold->bprev;
       if (bprev && (*bprev = bnext = thing->bnext))  // unlink from block map
-        bnext->bprev = bprev;
+        P_MobjCold(bnext)->bprev = bprev;
     }
 }
 
@@ -262,6 +265,7 @@ void P_UnsetThingPosition (mobj_t *thing)
 
 void P_SetThingPosition(mobj_t *thing)
 {                                                      // link into subsector
+  mobjcold_t *cold = P_MobjCold(thing);
   subsector_t *ss = thing->subsector = R_PointInSubsector(thing->x, thing->y);
   if (!(thing->flags & MF_NOSECTOR))
     {
@@ -273,8 +277,8 @@ void P_SetThingPosition(mobj_t *thing)
       mobj_t **link = &ss->sector->thinglist;
       mobj_t *snext = *link;
       if ((thing->snext = snext))
-        snext->sprev = &thing->snext;
-      thing->sprev = link;
+        P_MobjCold(snext)->sprev = &thing->snext;
+      cold->sprev = link;
       *link = thing;
 
       // phares 3/16/98
@@ -291,7 +295,7 @@ void P_SetThingPosition(mobj_t *thing)
       // added, new sector links are created.
 
       P_CreateSecNodeList(thing,thing->x,thing->y);
-      thing->touching_sectorlist = _g->sector_list; // Attach to Thing's mobj_t
+      cold->touching_sectorlist = _g->sector_list; // Attach to Thing's mobj_t
       _g->sector_list = NULL; // clear for next time
     }
 
@@ -299,22 +303,22 @@ void P_SetThingPosition(mobj_t *thing)
   if (!(thing->flags & MF_NOBLOCKMAP))
     {
       // inert things don't need to be in blockmap
-      int blockx = (thing->x - _g->bmaporgx)>>MAPBLOCKSHIFT;
-      int blocky = (thing->y - _g->bmaporgy)>>MAPBLOCKSHIFT;
-      if (blockx>=0 && blockx < _g->bmapwidth && blocky>=0 && blocky < _g->bmapheight)
+      int blockx = (thing->x - _g->bmaporgx)>>THINGBLOCKSHIFT;
+      int blocky = (thing->y - _g->bmaporgy)>>THINGBLOCKSHIFT;
+      if (blockx>=0 && blockx < _g->tbmapwidth && blocky>=0 && blocky < _g->tbmapheight)
         {
         // killough 8/11/98: simpler scheme using pointer-to-pointer prev
         // pointers, allows head nodes to be treated like everything else
 
-        mobj_t **link = &_g->blocklinks[blocky*_g->bmapwidth+blockx];
+        mobj_t **link = &_g->blocklinks[blocky*_g->tbmapwidth+blockx];
         mobj_t *bnext = *link;
         if ((thing->bnext = bnext))
-          bnext->bprev = &thing->bnext;
-        thing->bprev = link;
+          P_MobjCold(bnext)->bprev = &thing->bnext;
+        cold->bprev = link;
         *link = thing;
       }
       else        // thing is off the map
-        thing->bnext = NULL, thing->bprev = NULL;
+        thing->bnext = NULL, cold->bprev = NULL;
     }
 }
 
@@ -342,7 +346,8 @@ boolean P_BlockLinesIterator(int x, int y, boolean func(const line_t*))
     if (x<0 || y<0 || x>=_g->bmapwidth || y>=_g->bmapheight)
         return true;
 
-    const int offset = _g->blockmap[y*_g->bmapwidth+x];
+    // Offsets are unsigned, lumps from wadopt -blockmap can pass 32K shorts.
+    const int offset = (unsigned short)_g->blockmap[y*_g->bmapwidth+x];
     const short* list = _g->blockmaplump+offset;     // original was reading         // phares
 
 
@@ -352,6 +357,7 @@ boolean P_BlockLinesIterator(int x, int y, boolean func(const line_t*))
     // Most demos go out of sync, and maybe other problems happen, if we
     // don't consider linedef 0. For safety this should be qualified.
 
+    // wadopt -blockmap drops the 0 and points one short early instead.
     list++;     // skip 0 starting delimiter                      // phares
 
     const int vcount = _g->validcount;
@@ -380,12 +386,14 @@ boolean P_BlockLinesIterator(int x, int y, boolean func(const line_t*))
 // P_BlockThingsIterator
 //
 // killough 5/3/98: reformatted, cleaned up
+//
+// x and y are in THINGBLOCKSHIFT blocks.
 
 boolean P_BlockThingsIterator(int x, int y, boolean func(mobj_t*))
 {
   mobj_t *mobj;
-  if (!(x<0 || y<0 || x>=_g->bmapwidth || y>=_g->bmapheight))
-    for (mobj = _g->blocklinks[y*_g->bmapwidth+x]; mobj; mobj = mobj->bnext)
+  if (!(x<0 || y<0 || x>=_g->tbmapwidth || y>=_g->tbmapheight))
+    for (mobj = _g->blocklinks[y*_g->tbmapwidth+x]; mobj; mobj = mobj->bnext)
       if (!func(mobj))
         return false;
   return true;
@@ -400,7 +408,27 @@ static boolean check_intercept(void)
 {
     size_t offset = _g->intercept_p - _g->intercepts;
 
-    return (offset < MAXINTERCEPTS);
+    if (offset < MAXINTERCEPTS)
+        return true;
+
+    _g->interceptoverflows++;
+
+    return false;
+}
+
+//
+// P_PrintInterceptStats
+// Reports the most intercepts a trace needed since the last report,
+// and how many traces gave up for want of room.
+//
+
+void P_PrintInterceptStats(void)
+{
+  if (_g->interceptspeak)
+    lprintf(LO_INFO, "P_PathTraverse: %u of %d intercepts peak, %u overflows",
+            _g->interceptspeak, MAXINTERCEPTS, _g->interceptoverflows);
+
+  _g->interceptspeak = _g->interceptoverflows = 0;
 }
 
 
@@ -413,23 +441,26 @@ static boolean check_intercept(void)
 // are on opposite sides of the trace.
 //
 // killough 5/3/98: reformatted, cleaned up
+//
+// dl is the line as P_MakeDivline gives it, its v2 is v1 + dx,dy.
 
-boolean PIT_AddLineIntercepts(const line_t *ld)
+static boolean P_AddLineIntercept(const divline_t *dl, int lineno)
 {
   int       s1;
   int       s2;
   fixed_t   frac;
-  divline_t dl;
 
   // avoid precision problems with two routines
   if (_g->trace.dx >  FRACUNIT*16 || _g->trace.dy >  FRACUNIT*16 ||
       _g->trace.dx < -FRACUNIT*16 || _g->trace.dy < -FRACUNIT*16)
     {
-      s1 = P_PointOnDivlineSide (ld->v1.x, ld->v1.y, &_g->trace);
-      s2 = P_PointOnDivlineSide (ld->v2.x, ld->v2.y, &_g->trace);
+      s1 = P_PointOnDivlineSide (dl->x, dl->y, &_g->trace);
+      s2 = P_PointOnDivlineSide (dl->x+dl->dx, dl->y+dl->dy, &_g->trace);
     }
   else
     {
+      const line_t *ld = &_g->lines[lineno];
+
       s1 = P_PointOnLineSide (_g->trace.x, _g->trace.y, ld);
       s2 = P_PointOnLineSide (_g->trace.x+_g->trace.dx, _g->trace.y+_g->trace.dy, ld);
     }
@@ -438,8 +469,7 @@ boolean PIT_AddLineIntercepts(const line_t *ld)
     return true;        // line isn't crossed
 
   // hit the line
-  P_MakeDivline(ld, &dl);
-  frac = P_InterceptVector2(&_g->trace, &dl);
+  frac = P_InterceptVector2(&_g->trace, dl);
 
   if (frac < 0)
     return true;        // behind source
@@ -449,12 +479,114 @@ boolean PIT_AddLineIntercepts(const line_t *ld)
 
   _g->intercept_p->frac = frac;
   _g->intercept_p->isaline = true;
-  _g->intercept_p->d.line = ld;
+  _g->intercept_p->d.line = &_g->lines[lineno];
   _g->intercept_p++;
 
   return true;  // continue
 }
 
+boolean PIT_AddLineIntercepts(const line_t *ld)
+{
+  divline_t dl;
+
+  P_MakeDivline(ld, &dl);
+
+  return P_AddLineIntercept(&dl, ld->lineno);
+}
+
+//
+// P_StartFan
+// Opens a fan: a run of traces, usually from one spot, that cross
+// many of the same mapblocks, like the pellets of a shotgun. The
+// first trace through a block copies the block's lines to RAM and
+// the others read them from there instead of going back to the
+// blockmap and the line lumps. Lines never move, so the traces find
+// exactly what they would have anyway. Fans may nest, the cache is
+// kept until the outermost P_EndFan.
+//
+
+void P_StartFan(void)
+{
+  if (_g->fandepth++)
+    return;
+
+  _g->numfanblocks = 0;
+  _g->numfanlines = 0;
+  memset(_g->fanhash, 0, sizeof(_g->fanhash));
+}
+
+void P_EndFan(void)
+{
+  _g->fandepth--;
+}
+
+//
+// P_FanLinesIterator
+// P_BlockLinesIterator with PIT_AddLineIntercepts through the fan
+// cache. A block that doesn't fit is read from the blockmap as usual.
+//
+
+static boolean P_FanLinesIterator(int x, int y)
+{
+  if (x<0 || y<0 || x>=_g->bmapwidth || y>=_g->bmapheight)
+    return true;
+
+  const int block = y*_g->bmapwidth+x;
+  unsigned int h = block & (FANHASHSIZE-1);
+
+  for ( ; _g->fanhash[h]; h = (h+1) & (FANHASHSIZE-1))
+    if (_g->fanblocks[_g->fanhash[h]-1].block == block)
+      break;
+
+  if (!_g->fanhash[h])
+    {
+      // Same list walk as P_BlockLinesIterator.
+      const short* list = _g->blockmaplump + (unsigned short)_g->blockmap[block] + 1;
+      int count = 0;
+
+      while (list[count] != -1)
+        count++;
+
+      if (_g->numfanblocks == MAXFANBLOCKS || _g->numfanlines + count > MAXFANLINES)
+        return P_BlockLinesIterator(x, y, PIT_AddLineIntercepts);
+
+      fanblock_t *fb = &_g->fanblocks[_g->numfanblocks++];
+
+      fb->block = block;
+      fb->firstline = _g->numfanlines;
+      fb->numlines = count;
+
+      for (int i = 0; i < count; i++)
+        {
+          fanline_t *fl = &_g->fanlines[_g->numfanlines++];
+
+          fl->lineno = list[i];
+          P_MakeDivline(&_g->lines[list[i]], &fl->dl);
+        }
+
+      _g->fanhash[h] = _g->numfanblocks;
+    }
+
+  const fanblock_t *fb = &_g->fanblocks[_g->fanhash[h]-1];
+  const fanline_t *fl = &_g->fanlines[fb->firstline];
+  const int vcount = _g->validcount;
+
+  for (int i = fb->numlines; i--; fl++)
+    {
+      linedata_t *lt = &_g->linedata[fl->lineno];
+
+      if (lt->validcount == vcount)
+        continue;       // line has already been checked
+
+      lt->validcount = vcount;
+
+      if (!P_AddLineIntercept(&fl->dl, fl->lineno))
+        return false;
+    }
+
+  return true;
+}
+
 //
 // PIT_AddThingIntercepts
 //
@@ -517,23 +649,33 @@ boolean PIT_AddThingIntercepts(mobj_t *thing)
 // for all lines.
 //
 // killough 5/3/98: reformatted, cleaned up
+//
+// The intercepts are insertion sorted once instead of scanning for
+// the nearest one each step. Ties stay in the order they were added,
+// which is the order the scan took them in. They come in roughly
+// near to far from the block walk, so the sort has little to move.
 
 boolean P_TraverseIntercepts(traverser_t func, fixed_t maxfrac)
 {
-  intercept_t *in = NULL;
-  int count = _g->intercept_p - _g->intercepts;
-  while (count--)
+  intercept_t *in;
+
+  for (in = _g->intercepts+1; in < _g->intercept_p; in++)
     {
-      fixed_t dist = INT_MAX;
-      intercept_t *scan;
-      for (scan = _g->intercepts; scan < _g->intercept_p; scan++)
-        if (scan->frac < dist)
-          dist = (in=scan)->frac;
-      if (dist > maxfrac)
+      const intercept_t t = *in;
+      intercept_t *scan = in;
+
+      for ( ; scan > _g->intercepts && scan[-1].frac > t.frac; scan--)
+        *scan = scan[-1];
+
+      *scan = t;
+    }
+
+  for (in = _g->intercepts; in < _g->intercept_p; in++)
+    {
+      if (in->frac > maxfrac)
         return true;    // checked everything in range
       if (!func(in))
         return false;           // don't bother going farther
-      in->frac = INT_MAX;
     }
   return true;                  // everything was traversed
 }
@@ -558,6 +700,8 @@ boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
   int     mapx, mapy;
   int     mapxstep, mapystep;
   int     count;
+  const int thingshift = THINGBLOCKSHIFT-MAPBLOCKSHIFT;
+  int     thingx = INT_MIN, thingy = INT_MIN;
 
   _g->validcount++;
   _g->intercept_p = _g->intercepts;
@@ -629,20 +773,30 @@ boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
 
   // Step through map blocks.
   // Count is present to prevent a round off error
-  // from skipping the break.
+  // from skipping the break. 64 steps of 128 unit blocks,
+  // scaled for finer blockmaps.
 
   mapx = xt1;
   mapy = yt1;
 
-  for (count = 0; count < 64; count++)
+  for (count = 0; count < 64 << (FRACBITS+7-MAPBLOCKSHIFT); count++)
     {
       if (flags & PT_ADDLINES)
-        if (!P_BlockLinesIterator(mapx, mapy,PIT_AddLineIntercepts))
+        if (!(_g->fandepth ? P_FanLinesIterator(mapx, mapy) :
+              P_BlockLinesIterator(mapx, mapy,PIT_AddLineIntercepts)))
           return false; // early out
 
+      // Each thing block the trace crosses is one run of line blocks,
+      // so it is only searched when the trace moves into the next one.
       if (flags & PT_ADDTHINGS)
-        if (!P_BlockThingsIterator(mapx, mapy,PIT_AddThingIntercepts))
-          return false; // early out
+        if (!thingshift || (mapx>>thingshift) != thingx || (mapy>>thingshift) != thingy)
+          {
+            thingx = mapx>>thingshift;
+            thingy = mapy>>thingshift;
+
+            if (!P_BlockThingsIterator(thingx, thingy,PIT_AddThingIntercepts))
+              return false; // early out
+          }
 
       if (mapx == xt2 && mapy == yt2)
         break;
@@ -660,6 +814,9 @@ boolean P_PathTraverse(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2,
           }
     }
 
+  if ((unsigned int)(_g->intercept_p - _g->intercepts) > _g->interceptspeak)
+    _g->interceptspeak = _g->intercept_p - _g->intercepts;
+
   // go through the sorted list
   return P_TraverseIntercepts(trav, FRACUNIT);
 }
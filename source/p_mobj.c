@@ -472,6 +472,7 @@ void P_NightmareRespawn(mobj_t* mobj)
 //Thinker function for stuff that doesn't need to do anything
 //interesting.
 //Just cycles through the states. Allows sprite animation to work.
+//Once it reaches a state that lasts forever it goes dormant.
 void P_MobjBrainlessThinker(mobj_t* mobj)
 {
     // cycle through states,
@@ -486,22 +487,20 @@ void P_MobjBrainlessThinker(mobj_t* mobj)
         if (!mobj->tics)
             P_SetMobjState (mobj, mobj->state->nextstate);
     }
+    else
+        P_SleepThing(mobj);
 }
 
 
 
-static think_t P_ThinkerFunctionForType(mobjtype_t type, mobj_t* mobj)
+static think_t P_ThinkerFunctionForType(mobjtype_t type)
 {
     //Full thinking ability.
     if(type < MT_MISC0)
         return P_MobjThinker;
 
-    //Just state cycles.
-    if(mobj->tics != -1)
-        return P_MobjBrainlessThinker;
-
-    //No thinking at all.
-    return NULL;
+    //Just state cycles, and none at all once tics is -1.
+    return P_MobjBrainlessThinker;
 }
 
 //
@@ -510,24 +509,26 @@ static think_t P_ThinkerFunctionForType(mobjtype_t type, mobj_t* mobj)
 
 static mobj_t* P_NewMobj()
 {
-    mobj_t* mobj = NULL;
+    mobj_t* mobj = _g->thingFreeList;
 
-    for(int i = _g->thingPoolSize-1; i >= 0; i--)
+    if(mobj)
     {
-        if(_g->thingPool[i].type == MT_NOTHING)
-        {
-            mobj = &_g->thingPool[i];
-            memset (mobj, 0, sizeof (*mobj));
+        _g->thingFreeList = (mobj_t*)mobj->thinker.next;
 
-            mobj->flags = MF_POOLED;
-            return mobj;
-        }
-    }
+        memset (mobj, 0, sizeof (*mobj));
+
+        memset (P_MobjCold(mobj), 0, sizeof(mobjcold_t));
 
-    if(mobj == NULL)
+        if(++_g->thingPoolUsed > _g->thingPoolPeak)
+            _g->thingPoolPeak = _g->thingPoolUsed;
+    }
+    else
     {
-        mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
-        memset (mobj, 0, sizeof (*mobj));
+        // The cold record rides along behind the mobj.
+        mobj = Z_Malloc (sizeof(*mobj) + sizeof(mobjcold_t), PU_LEVSPEC, NULL);
+        memset (mobj, 0, sizeof(*mobj) + sizeof(mobjcold_t));
+
+        _g->thingPoolOverflow++;
     }
 
     return mobj;
@@ -565,23 +566,27 @@ mobj_t* P_SpawnMobj(fixed_t x,fixed_t y,fixed_t z,mobjtype_t type)
     mobj->tics   = st->tics;
     mobj->sprite = st->sprite;
     mobj->frame  = st->frame;
-    mobj->touching_sectorlist = NULL; // NULL head of sector list // phares 3/13/98
+    P_MobjCold(mobj)->touching_sectorlist = NULL; // NULL head of sector list // phares 3/13/98
 
     // set subsector and/or block links
 
     P_SetThingPosition (mobj);
 
-    mobj->dropoffz =           /* killough 11/98: for tracking dropoffs */
+    P_MobjCold(mobj)->dropoffz =           /* killough 11/98: for tracking dropoffs */
             mobj->floorz   = mobj->subsector->sector->floorheight;
     mobj->ceilingz = mobj->subsector->sector->ceilingheight;
 
     mobj->z = z == ONFLOORZ ? mobj->floorz : z == ONCEILINGZ ?
                                   mobj->ceilingz - mobj->height : z;
 
-    mobj->thinker.function = P_ThinkerFunctionForType(type, mobj);
+    mobj->thinker.function = P_ThinkerFunctionForType(type);
 
-    mobj->target = mobj->tracer = mobj->lastenemy = NULL;
+    mobj->target = P_MobjCold(mobj)->tracer = P_MobjCold(mobj)->lastenemy = NULL;
     P_AddThinker (&mobj->thinker);
+
+    // Static decorations and pickups never think at all.
+    if (mobj->thinker.function == P_MobjBrainlessThinker && mobj->tics == -1)
+        P_SleepThing(mobj);
     if (!((mobj->flags ^ MF_COUNTKILL) & (MF_FRIEND | MF_COUNTKILL)))
         _g->totallive++;
     return mobj;
@@ -620,10 +625,13 @@ void P_RemoveMobj (mobj_t* mobj)
   if (!_g->demoplayback)
   {
     P_SetTarget(&mobj->target,    NULL);
-    P_SetTarget(&mobj->tracer,    NULL);
-    P_SetTarget(&mobj->lastenemy, NULL);
+    P_SetTarget(&P_MobjCold(mobj)->tracer,    NULL);
+    P_SetTarget(&P_MobjCold(mobj)->lastenemy, NULL);
   }
-  // free block
+  // free block, which needs it back on the thinker list
+
+  if (mobj->flags & MF_DORMANT)
+    P_WakeThing(mobj);
 
   P_RemoveThing (mobj);
 }
@@ -1003,19 +1011,37 @@ void P_SpawnPlayerMissile(mobj_t* source,mobjtype_t type)
   // killough 7/19/98: autoaiming was not in original beta
     {
       // killough 8/2/98: prefer autoaiming at enemies
-      unsigned int mask = MF_FRIEND;
+      // The unmasked second round takes the same three rays, so it
+      // reads back what the first one passed over on each.
+      static const int turn[3] = { 0, 1<<26, -(1<<26) };
+      mobj_t *fallback[3];
+      fixed_t fallbackslope[3];
+      int i;
 
-      do
-  {
-    slope = P_AimLineAttack(source, an, 16*64*FRACUNIT, mask);
-    if (!_g->linetarget)
-      slope = P_AimLineAttack(source, an += 1<<26, 16*64*FRACUNIT, mask);
-    if (!_g->linetarget)
-      slope = P_AimLineAttack(source, an -= 2<<26, 16*64*FRACUNIT, mask);
-    if (!_g->linetarget)
-      an = source->angle, slope = 0;
-  }
-      while (mask && (mask=0, !_g->linetarget));  // killough 8/2/98
+      P_StartFan();
+
+      for (i = 0; i < 3; i++)
+        {
+          slope = P_AimLineAttack(source, an = source->angle + turn[i], 16*64*FRACUNIT, MF_FRIEND);
+          if (_g->linetarget)
+            break;
+          fallback[i] = _g->aimfallback, fallbackslope[i] = _g->aimfallbackslope;
+        }
+
+      if (!_g->linetarget)
+        for (i = 0; i < 3; i++)
+          {
+            _g->aimfallback = fallback[i], _g->aimfallbackslope = fallbackslope[i];
+            slope = P_AimFallback();
+            an = source->angle + turn[i];
+            if (_g->linetarget)
+              break;
+          }
+
+      if (!_g->linetarget)
+        an = source->angle, slope = 0;
+
+      P_EndFan();
     }
 
   x = source->x;
@@ -215,7 +215,7 @@ int EV_DoPlat
 
     // Create a thinker
     rtn = 1;
-    plat = Z_Malloc( sizeof(*plat), PU_LEVSPEC, 0);
+    plat = P_NewThinker(tp_plat);
     memset(plat, 0, sizeof(*plat));
     P_AddThinker(&plat->thinker);
 
@@ -391,7 +391,7 @@ void P_AddActivePlat(plat_t* plat)
 {
     platlist_t* old_head = _g->activeplats;
 
-    platlist_t *list = Z_Malloc(sizeof *list, PU_LEVEL, &_g->activeplats);
+    platlist_t *list = Z_Malloc(sizeof *list, PU_LEVSPEC, &_g->activeplats);
     list->plat = plat;
     plat->list = list;
     if ((list->next = old_head))
@@ -413,7 +413,7 @@ void P_RemoveActivePlat(plat_t* plat)
   platlist_t *list = plat->list;
   plat->sector->floordata = NULL; //jff 2/23/98 multiple thinkers
 
-  P_RemoveThinker(&plat->thinker);
+  P_RemoveThinker(&plat->thinker, tp_plat);
 
   if (list->prev && (*list->prev = list->next))
     list->next->prev = list->prev;
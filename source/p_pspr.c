@@ -638,7 +638,7 @@ void A_Punch(player_t *player, pspdef_t *psp)
   if (
       (slope = P_AimLineAttack(player->mo, angle, MELEERANGE, MF_FRIEND),
        !_g->linetarget))
-    slope = P_AimLineAttack(player->mo, angle, MELEERANGE, 0);
+    slope = P_AimFallback();
 
   P_LineAttack(player->mo, angle, MELEERANGE, slope, damage);
 
@@ -670,7 +670,7 @@ void A_Saw(player_t *player, pspdef_t *psp)
   if (
       (slope = P_AimLineAttack(player->mo, angle, MELEERANGE+1, MF_FRIEND),
        !_g->linetarget))
-    slope = P_AimLineAttack(player->mo, angle, MELEERANGE+1, 0);
+    slope = P_AimFallback();
 
   P_LineAttack(player->mo, angle, MELEERANGE+1, slope, damage);
 
@@ -745,18 +745,37 @@ static void P_BulletSlope(mobj_t *mo)
 {
   angle_t an = mo->angle;    // see which target is to be aimed at
 
-  /* killough 8/2/98: make autoaiming prefer enemies */
-  unsigned int mask = MF_FRIEND;
+  /* killough 8/2/98: make autoaiming prefer enemies
+   *
+   * The second, unmasked round used to trace an-(1<<26), an and
+   * an-(2<<26) again as an was never reset. The first two were traced
+   * by the first round already, so take what it passed over there. */
+  mobj_t *fallback[2];
+  fixed_t fallbackslope[2];
 
-  do
+  _g->bulletslope = P_AimLineAttack(mo, an, 16*64*FRACUNIT, MF_FRIEND);
+  if (_g->linetarget)
+    return;
+  fallback[1] = _g->aimfallback, fallbackslope[1] = _g->aimfallbackslope;
+
+  _g->bulletslope = P_AimLineAttack(mo, an += 1<<26, 16*64*FRACUNIT, MF_FRIEND);
+  if (_g->linetarget)
+    return;
+
+  _g->bulletslope = P_AimLineAttack(mo, an -= 2<<26, 16*64*FRACUNIT, MF_FRIEND);
+  if (_g->linetarget)
+    return;
+  fallback[0] = _g->aimfallback, fallbackslope[0] = _g->aimfallbackslope;
+
+  for (int i = 0; i < 2; i++)
     {
-      _g->bulletslope = P_AimLineAttack(mo, an, 16*64*FRACUNIT, mask);
-      if (!_g->linetarget)
-  _g->bulletslope = P_AimLineAttack(mo, an += 1<<26, 16*64*FRACUNIT, mask);
-      if (!_g->linetarget)
-  _g->bulletslope = P_AimLineAttack(mo, an -= 2<<26, 16*64*FRACUNIT, mask);
+      _g->aimfallback = fallback[i], _g->aimfallbackslope = fallbackslope[i];
+      _g->bulletslope = P_AimFallback();
+      if (_g->linetarget)
+        return;
     }
-  while (mask && (mask=0, !_g->linetarget));  /* killough 8/2/98 */
+
+  _g->bulletslope = P_AimLineAttack(mo, an -= 1<<26, 16*64*FRACUNIT, 0);
 }
 
 //
@@ -789,8 +808,10 @@ void A_FirePistol(player_t *player, pspdef_t *psp)
   player->ammo[weaponinfo[player->readyweapon].ammo]--;
 
   A_FireSomething(player,0);                                      // phares
+  P_StartFan();
   P_BulletSlope(player->mo);
   P_GunShot(player->mo, !player->refire);
+  P_EndFan();
 }
 
 //
@@ -808,10 +829,12 @@ void A_FireShotgun(player_t *player, pspdef_t *psp)
 
   A_FireSomething(player,0);                                      // phares
 
+  P_StartFan();
   P_BulletSlope(player->mo);
 
   for (i=0; i<7; i++)
     P_GunShot(player->mo, false);
+  P_EndFan();
 }
 
 //
@@ -828,6 +851,7 @@ void A_FireShotgun2(player_t *player, pspdef_t *psp)
 
   A_FireSomething(player,0);                                      // phares
 
+  P_StartFan();
   P_BulletSlope(player->mo);
 
   for (i=0; i<20; i++)
@@ -841,6 +865,7 @@ void A_FireShotgun2(player_t *player, pspdef_t *psp)
       P_LineAttack(player->mo, angle, MISSILERANGE, _g->bulletslope +
                    ((t - P_Random())<<5), damage);
     }
+  P_EndFan();
 }
 
 //
@@ -860,9 +885,11 @@ void A_FireCGun(player_t *player, pspdef_t *psp)
 
   A_FireSomething(player,psp->state - &states[S_CHAIN1]);           // phares
 
+  P_StartFan();
   P_BulletSlope(player->mo);
 
   P_GunShot(player->mo, !player->refire);
+  P_EndFan();
 }
 
 void A_Light0(player_t *player, pspdef_t *psp)
@@ -889,6 +916,8 @@ void A_BFGSpray(mobj_t *mo)
 {
   int i;
 
+  P_StartFan();
+
   for (i=0 ; i<40 ; i++)  // offset angles from its attack angle
     {
       int j, damage;
@@ -900,7 +929,7 @@ void A_BFGSpray(mobj_t *mo)
       if (
          (P_AimLineAttack(mo->target, an, 16*64*FRACUNIT, MF_FRIEND),
          !_g->linetarget))
-        P_AimLineAttack(mo->target, an, 16*64*FRACUNIT, 0);
+        P_AimFallback();
 
       if (!_g->linetarget)
         continue;
@@ -913,6 +942,8 @@ void A_BFGSpray(mobj_t *mo)
 
       P_DamageMobj(_g->linetarget, mo->target, mo->target, damage);
     }
+
+  P_EndFan();
 }
 
 //
@@ -105,6 +105,8 @@ static void P_LoadSubsectors (int lump)
     _g->subsectors[i].numlines  = (unsigned short)SHORT(data[i].numsegs );
     _g->subsectors[i].firstline = (unsigned short)SHORT(data[i].firstseg);
   }
+
+  W_UnlockLumpNum(lump);
 }
 
 //
@@ -139,6 +141,8 @@ static void P_LoadSectors (int lump)
       ss->thinglist = NULL;
       ss->touching_thinglist = NULL;            // phares 3/14/98
     }
+
+  W_UnlockLumpNum(lump);
 }
 
 
@@ -180,12 +184,19 @@ static void P_LoadThings (int lump)
     if ((!data) || (!numthings))
         I_Error("P_LoadThings: no things in level");
 
-    _g->thingPool = Z_Calloc(numthings, sizeof(mobj_t), PU_LEVEL, NULL);
-    _g->thingPoolSize = numthings;
+    // Room for every thing in the map plus what gets fired about.
+    _g->thingPoolSize = numthings + MOBJRESERVE;
+    _g->thingPool = Z_Calloc(_g->thingPoolSize, sizeof(mobj_t), PU_LEVEL, NULL);
+    _g->thingCold = Z_Calloc(_g->thingPoolSize, sizeof(mobjcold_t), PU_LEVEL, NULL);
+    _g->thingFreeList = NULL;
+    _g->thingPoolUsed = _g->thingPoolPeak = _g->thingPoolOverflow = 0;
+    _g->thingsDormant = 0;
 
-    for(int i = 0; i < numthings; i++)
+    for(i = _g->thingPoolSize - 1; i >= 0; i--)
     {
         _g->thingPool[i].type = MT_NOTHING;
+        _g->thingPool[i].thinker.next = (thinker_t*)_g->thingFreeList;
+        _g->thingFreeList = &_g->thingPool[i];
     }
 
     for (i=0; i<numthings; i++)
@@ -198,6 +209,8 @@ static void P_LoadThings (int lump)
         // Do spawn all other stuff.
         P_SpawnMapThing(mt);
     }
+
+    W_UnlockLumpNum(lump);
 }
 
 //
@@ -289,6 +302,8 @@ static void P_LoadSideDefs2(int lump)
         R_GetTexture(sd->toptexture);
         R_GetTexture(sd->bottomtexture);
     }
+
+    W_UnlockLumpNum(lump);
 }
 
 //
@@ -321,6 +336,8 @@ typedef struct linelist_t        // type used to list lines in each block
 
 static void P_LoadBlockMap (int lump)
 {
+    int marker;
+
     _g->blockmaplump = W_CacheLumpNum(lump);
 
     _g->bmaporgx = _g->blockmaplump[0]<<FRACBITS;
@@ -328,9 +345,25 @@ static void P_LoadBlockMap (int lump)
     _g->bmapwidth = _g->blockmaplump[2];
     _g->bmapheight = _g->blockmaplump[3];
 
+    // wadopt -blockmap leaves 0x7fxx after the offsets,
+    // xx being log2 of the block size in map units.
+    _g->bmapshift = FRACBITS+7;
+
+    if (W_LumpLength(lump) > (int)((4 + _g->bmapwidth*_g->bmapheight) * sizeof(short)))
+    {
+        marker = _g->blockmaplump[4 + _g->bmapwidth*_g->bmapheight];
+
+        if ((marker & 0xff00) == 0x7f00 && (marker & 0xff) >= 5 && (marker & 0xff) <= 7)
+            _g->bmapshift = FRACBITS + (marker & 0xff);
+    }
+
+
+    // Things keep 128 unit blocks over the same area, see THINGBLOCKSHIFT.
+    _g->tbmapwidth = ((_g->bmapwidth << (_g->bmapshift-FRACBITS)) + 127) >> 7;
+    _g->tbmapheight = ((_g->bmapheight << (_g->bmapshift-FRACBITS)) + 127) >> 7;
 
     // clear out mobj chains - CPhipps - use calloc
-    _g->blocklinks = Z_Calloc (_g->bmapwidth*_g->bmapheight,sizeof(*_g->blocklinks),PU_LEVEL,0);
+    _g->blocklinks = Z_Calloc (_g->tbmapwidth*_g->tbmapheight,sizeof(*_g->blocklinks),PU_LEVEL,0);
 
     _g->blockmap = _g->blockmaplump+4;
 }
@@ -352,6 +385,39 @@ static void P_LoadReject(int lumpnum)
   _g->rejectmatrix = W_CacheLumpNum(_g->rejectlump);
 }
 
+//
+// P_LoadPVS
+// Picks up the PVS lump wadopt -pvs puts after BLOCKMAP, if there
+// is one and it was built from this map's nodes. Without it the
+// renderer simply walks the whole BSP.
+//
+static void P_LoadPVS(int lumpnum)
+{
+  const char* name = W_GetNameForNum(lumpnum + ML_PVS);
+  const mappvs_t* pvs;
+
+  _g->pvs = NULL;
+  _g->pvssector = -1;
+
+  if (!name || strncasecmp(name, "PVS", 8))
+    return;
+
+  pvs = W_CacheLumpNum(lumpnum + ML_PVS);
+
+  if (pvs->numsectors != _g->numsectors || pvs->numnodes != numnodes ||
+      pvs->numsubsectors != _g->numsubsectors ||
+      pvs->rowbytes != (numnodes + _g->numsubsectors + 7) / 8 ||
+      pvs->nodeshash != PVS_NodesHash((const byte*)nodes, numnodes * sizeof(mapnode_t)))
+  {
+    lprintf(LO_WARN, "P_LoadPVS: PVS lump does not match the map, ignored\n");
+    W_UnlockLumpNum(lumpnum + ML_PVS);
+    return;
+  }
+
+  _g->pvs = pvs;
+  _g->pvsrow = Z_Malloc(pvs->rowbytes, PU_LEVEL, NULL);
+}
+
 //
 // P_GroupLines
 // Builds sector line lists and subsector sector numbers.
@@ -445,10 +511,100 @@ static int P_GroupLines (void)
 }
 
 
+//
+// P_BuildSoundGraph
+// Sector neighbours for P_NoiseAlert, one entry per sector pair
+// joined by a two sided line. Sound gets through if any of those
+// lines lacks ML_SOUNDBLOCK, so that is all the entry keeps.
+//
+static void P_BuildSoundGraph(void)
+{
+    int i, pass, count = 0;
+
+    _g->sectoredges = Z_Malloc((_g->numsectors+1)*sizeof(unsigned short), PU_LEVEL, 0);
+    _g->soundqueue = Z_Malloc(_g->numsectors*sizeof(unsigned short), PU_LEVEL, 0);
+    _g->soundedges = NULL;
+
+    // Count, then fill. Until then the queue holds the
+    // neighbours found so far for the sector being counted.
+    for (pass = 0; pass < 2; pass++)
+    {
+        count = 0;
+
+        for (i = 0; i < _g->numsectors; i++)
+        {
+            const sector_t *sec = &_g->sectors[i];
+            int l, first = count;
+
+            _g->sectoredges[i] = first;
+
+            for (l = 0; l < sec->linecount; l++)
+            {
+                const line_t *check = sec->lines[l];
+                unsigned int other, e;
+
+                if (!(check->flags & ML_TWOSIDED) || check->sidenum[1] == NO_INDEX)
+                    continue;
+
+                other = _g->sides[check->sidenum[_g->sides[check->sidenum[0]].sector==sec]].sector - _g->sectors;
+
+                if (other == (unsigned int)i)
+                    continue;
+
+                for (e = first; e < (unsigned int)count; e++)
+                {
+                    if (((pass ? _g->soundedges[e] : _g->soundqueue[e - first]) & ~SE_SOUNDBLOCK) == other)
+                        break;
+                }
+
+                if (e == (unsigned int)count)
+                {
+                    if (pass)
+                        _g->soundedges[count] = other | SE_SOUNDBLOCK;
+                    else
+                        _g->soundqueue[count - first] = other;
+
+                    count++;
+                }
+
+                if (pass && !(check->flags & ML_SOUNDBLOCK))
+                    _g->soundedges[e] &= ~SE_SOUNDBLOCK;
+            }
+        }
+
+        _g->sectoredges[_g->numsectors] = count;
+
+        if (!pass)
+            _g->soundedges = Z_Malloc((count ? count : 1)*sizeof(unsigned short), PU_LEVEL, 0);
+    }
+}
+
+//
+// P_UnlockLevelLumps
+// Releases the map lumps that stay referenced for the whole level.
+//
+static void P_UnlockLevelLumps(int lumpnum)
+{
+    W_UnlockLumpNum(lumpnum+ML_VERTEXES);
+    W_UnlockLumpNum(lumpnum+ML_LINEDEFS);
+    W_UnlockLumpNum(lumpnum+ML_BLOCKMAP);
+    W_UnlockLumpNum(lumpnum+ML_NODES);
+    W_UnlockLumpNum(lumpnum+ML_SEGS);
+    W_UnlockLumpNum(lumpnum+ML_REJECT);
+
+    if (_g->pvs)
+    {
+        W_UnlockLumpNum(lumpnum+ML_PVS);
+        _g->pvs = NULL;
+    }
+}
+
 void P_FreeLevelData()
 {
     R_ResetPlanes();
 
+    R_UnlockTexturePatches();
+
     Z_FreeTags(PU_LEVEL, PU_PURGELEVEL-1);
 
     Z_Free(_g->braintargets);
@@ -486,6 +642,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
 
     if (_g->rejectlump != -1)
     { // cph - unlock the reject table
+        P_UnlockLevelLumps(_g->rejectlump - ML_REJECT);
         _g->rejectlump = -1;
     }
 
@@ -506,6 +663,14 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
 
     lumpnum = W_GetNumForName(lumpname);
 
+    W_PrintCacheStats();
+    Z_PrintStats();
+    R_PrintRenderStats();
+    P_PrintInterceptStats();
+
+    // Map lumps are stored together, pull them in with one pass.
+    W_ReadAheadLumps(lumpnum+ML_THINGS, ML_BLOCKMAP);
+
     _g->leveltime = 0; _g->totallive = 0;
 
     P_LoadVertexes  (lumpnum+ML_VERTEXES);
@@ -523,10 +688,14 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
 
     P_GroupLines();
 
+    P_BuildSoundGraph();
+
     // reject loading and underflow padding separated out into new function
     // P_GroupLines modified to return a number the underflow padding needs
     P_LoadReject(lumpnum);
 
+    P_LoadPVS(lumpnum);
+
     // Note: you don't need to clear player queue slots --
     // a much simpler fix is in g_game.c -- killough 10/98
 
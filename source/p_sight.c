@@ -54,7 +54,7 @@ boolean P_CrossBSPNode(int bspnum);
 
 
 
-boolean P_CheckSight(mobj_t *t1, mobj_t *t2)
+static boolean P_CheckSightUncached(mobj_t *t1, mobj_t *t2)
 {
   const sector_t *s1 = t1->subsector->sector;
   const sector_t *s2 = t2->subsector->sector;
@@ -101,3 +101,51 @@ boolean P_CheckSight(mobj_t *t1, mobj_t *t2)
   // the head node is the last node output
   return P_CrossBSPNode(numnodes-1);
 }
+
+//
+// P_CheckSight
+// Monsters ask about the same pair several times a tic, and again
+// the next tic if neither has moved. Remember recent answers until
+// either end moves or any sector changes height.
+//
+
+boolean P_CheckSight(mobj_t *t1, mobj_t *t2)
+{
+  const fixed_t sightz = t1->z + t1->height - (t1->height>>2);
+  unsigned int h;
+  sightcache_t *c;
+
+  h = (unsigned int)(t1->x ^ (t1->y * 3) ^ (t2->x * 5) ^ (t2->y * 7) ^ t2->z) >> FRACBITS;
+  c = &_g->sightcache[(h ^ (h >> 5)) & (SIGHTCACHESIZE-1)];
+
+  _g->sightchecks++;
+
+  if (c->version == _g->sightversion &&
+      c->t1x == t1->x && c->t1y == t1->y && c->sightz == sightz &&
+      c->t2x == t2->x && c->t2y == t2->y && c->t2z == t2->z && c->t2h == t2->height)
+  {
+    _g->sighthits++;
+    return c->result;
+  }
+
+  c->t1x = t1->x, c->t1y = t1->y, c->sightz = sightz;
+  c->t2x = t2->x, c->t2y = t2->y, c->t2z = t2->z, c->t2h = t2->height;
+  c->version = _g->sightversion;
+
+  return c->result = P_CheckSightUncached(t1, t2);
+}
+
+//
+// P_ClearSightCache
+// The old level's answers mean nothing on the new one.
+//
+
+void P_ClearSightCache(void)
+{
+  if (_g->sightchecks)
+    lprintf(LO_INFO, "P_CheckSight: %u checks, %u%% cached",
+            _g->sightchecks, (unsigned int)(((unsigned long long)_g->sighthits * 100) / _g->sightchecks));
+
+  _g->sightchecks = _g->sighthits = 0;
+  _g->sightversion++;
+}
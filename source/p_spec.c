@@ -2426,16 +2426,19 @@ void P_SpawnSpecials (void)
 // This is the main scrolling code
 // killough 3/7/98
 
-void T_Scroll(scroll_t *s)
+void T_Scrollers(scroll_t *s, unsigned int count)
 {
-    side_t *side  =_g->sides + s->affectee;
-    side->textureoffset++;
+    for (; count--; s++)
+    {
+        side_t *side  =_g->sides + s->affectee;
+        side->textureoffset++;
+    }
 }
 
 //
 // Add_Scroller()
 //
-// Add a generalized scroller to the thinker list.
+// Add a generalized scroller to the batched scroller class.
 //
 // type: the enumerated type of scrolling: floor, ceiling, floor carrier,
 //   wall, floor carrier & scroller
@@ -2452,10 +2455,8 @@ void T_Scroll(scroll_t *s)
 
 static void Add_Scroller(int affectee)
 {
-  scroll_t *s = Z_Malloc(sizeof *s, PU_LEVSPEC, 0);
-  s->thinker.function = T_Scroll;
+  scroll_t *s = P_NewBatchThinker(tb_scroll);
   s->affectee = affectee;
-  P_AddThinker(&s->thinker);
 }
 
 // Initialize the scrollers
@@ -37,17 +37,49 @@
 #include "p_tick.h"
 #include "p_map.h"
 
+#include "z_bmalloc.h"
+#include "lprintf.h"
+#include "i_system.h"
 #include "global_data.h"
 
 
 //
 // THINKERS
-// All thinkers should be allocated by Z_Malloc
-// so they can be operated on uniformly.
+// Special thinkers are allocated by P_NewThinker from a
+// pool per struct, mobjs come from the level's thing pool.
 // The actual structures will vary in size,
 // but the first element must be thinker_t.
 //
 
+// Stands in the thinker list for a run of dormant mobjs, which are
+// chained through thinker.next and point back here with thinker.prev.
+typedef struct
+{
+  thinker_t thinker;
+  mobj_t *first, *last;
+} dormant_t;
+
+#define THINKERPOOL(type, desc) { NULL, NULL, sizeof(type), 16, PU_LEVEL, desc, 0, 0, 0 }
+
+static struct block_memory_alloc_s thinkerpools[NUMTHINKERPOOLS] =
+{
+  [tp_ceiling]      = THINKERPOOL(ceiling_t,      "Ceilings"),
+  [tp_door]         = THINKERPOOL(vldoor_t,       "Doors"),
+  [tp_floor]        = THINKERPOOL(floormove_t,    "Floors"),
+  [tp_elevator]     = THINKERPOOL(elevator_t,     "Elevators"),
+  [tp_plat]         = THINKERPOOL(plat_t,         "Plats"),
+  [tp_fireflicker]  = THINKERPOOL(fireflicker_t,  "FireFlickers"),
+  [tp_lightflash]   = THINKERPOOL(lightflash_t,   "LightFlashes"),
+  [tp_dormant]      = THINKERPOOL(dormant_t,      "Dormant"),
+};
+
+static const unsigned short batchsizes[NUMTHINKERBATCHES] =
+{
+  [tb_strobe]       = sizeof(strobe_t),
+  [tb_glow]         = sizeof(glow_t),
+  [tb_scroll]       = sizeof(scroll_t),
+};
+
 
 
 //
@@ -56,9 +88,76 @@
 
 void P_InitThinkers(void)
 {
+  int i;
+
+  // The pools were freed with the last level, report how it went.
+  if (_g->thingPoolSize)
+    lprintf(LO_INFO, "P_NewMobj: %u/%u pooled, %u peak, %u overflowed, %u dormant",
+            _g->thingPoolUsed, _g->thingPoolSize, _g->thingPoolPeak, _g->thingPoolOverflow,
+            _g->thingsDormant);
+
+  if (_g->thinkertics)
+    lprintf(LO_INFO, "P_RunThinkers: %uus/tic over %u tics, mobj_t %u + %u cold bytes",
+            _g->thinkertime / _g->thinkertics, _g->thinkertics,
+            (unsigned int)sizeof(mobj_t), (unsigned int)sizeof(mobjcold_t));
+
+  _g->thinkertime = _g->thinkertics = 0;
+
+  P_ClearSightCache();
+
+  if (_g->thinkerbatches[tb_strobe].max)
+    lprintf(LO_INFO, "P_RunThinkers: %u strobes, %u glows, %u scrollers batched",
+            _g->thinkerbatches[tb_strobe].count, _g->thinkerbatches[tb_glow].count,
+            _g->thinkerbatches[tb_scroll].count);
+
+  // The arrays went with the level's PU_LEVSPEC blocks.
+  memset(_g->thinkerbatches, 0, sizeof(_g->thinkerbatches));
+
+  for (i = 0; i < NUMTHINKERPOOLS; i++)
+  {
+    if (thinkerpools[i].pools)
+      Z_BPrintStats(&thinkerpools[i]);
+
+    NULL_BLOCK_MEMORY_ALLOC_ZONE(thinkerpools[i]);
+  }
+
   thinkercap.prev = thinkercap.next  = &thinkercap;
 }
 
+//
+// P_NewThinker
+// Not cleared, the caller sets up the whole struct.
+//
+
+void* P_NewThinker(thinkerpool_t pool)
+{
+  return Z_BMalloc(&thinkerpools[pool]);
+}
+
+//
+// P_NewBatchThinker
+// Appends a cleared record to a batched class. The array may move
+// when it grows, so only hold on to the result while setting it up.
+//
+
+void* P_NewBatchThinker(thinkerbatch_t batch)
+{
+  thinkerarray_t *a = &_g->thinkerbatches[batch];
+  const unsigned int size = batchsizes[batch];
+  void *p;
+
+  if (a->count == a->max)
+  {
+    a->max = a->max ? a->max * 2 : 16;
+    a->data = Z_Realloc(a->data, a->max * size, PU_LEVSPEC, NULL);
+  }
+
+  p = (byte *)a->data + a->count++ * size;
+  memset(p, 0, size);
+
+  return p;
+}
+
 //
 // P_AddThinker
 // Adds a new thinker at the end of the list.
@@ -85,38 +184,62 @@ void P_AddThinker(thinker_t* thinker)
 // Called automatically as part of the thinker loop in P_RunThinkers(),
 // on nodes which are pending deletion.
 //
-// If this thinker has no more pointers referencing it indirectly,
-// remove it, and set currentthinker to one node preceeding it, so
-// that the next step in P_RunThinkers() will get its successor.
+// There is one per thinker pool, so a thinker finds its way back
+// to its pool without having to carry a type.
 //
 
-void P_RemoveThinkerDelayed(thinker_t *thinker)
+static void P_UnlinkThinker(thinker_t *thinker)
 {
-
     thinker_t *next = thinker->next;
     /* Note that currentthinker is guaranteed to point to us,
          * and since we're freeing our memory, we had better change that. So
          * point it to thinker->prev, so the iterator will correctly move on to
          * thinker->prev->next = thinker->next */
     (next->prev = thinker->prev)->next = next;
+}
 
-    Z_Free(thinker);
+#define P_REMOVETHINKERDELAYED(pool) \
+static void P_RemoveThinkerDelayed_##pool(thinker_t *thinker) \
+{ \
+    P_UnlinkThinker(thinker); \
+    Z_BFree(&thinkerpools[pool], thinker); \
 }
 
-void P_RemoveThingDelayed(thinker_t *thinker)
+P_REMOVETHINKERDELAYED(tp_ceiling)
+P_REMOVETHINKERDELAYED(tp_door)
+P_REMOVETHINKERDELAYED(tp_floor)
+P_REMOVETHINKERDELAYED(tp_elevator)
+P_REMOVETHINKERDELAYED(tp_plat)
+P_REMOVETHINKERDELAYED(tp_fireflicker)
+P_REMOVETHINKERDELAYED(tp_lightflash)
+P_REMOVETHINKERDELAYED(tp_dormant)
+
+static const think_t removethinkerdelayed[NUMTHINKERPOOLS] =
 {
+  [tp_ceiling]      = P_RemoveThinkerDelayed_tp_ceiling,
+  [tp_door]         = P_RemoveThinkerDelayed_tp_door,
+  [tp_floor]        = P_RemoveThinkerDelayed_tp_floor,
+  [tp_elevator]     = P_RemoveThinkerDelayed_tp_elevator,
+  [tp_plat]         = P_RemoveThinkerDelayed_tp_plat,
+  [tp_fireflicker]  = P_RemoveThinkerDelayed_tp_fireflicker,
+  [tp_lightflash]   = P_RemoveThinkerDelayed_tp_lightflash,
+  [tp_dormant]      = P_RemoveThinkerDelayed_tp_dormant,
+};
 
-    thinker_t *next = thinker->next;
-    /* Note that currentthinker is guaranteed to point to us,
-         * and since we're freeing our memory, we had better change that. So
-         * point it to thinker->prev, so the iterator will correctly move on to
-         * thinker->prev->next = thinker->next */
-    (next->prev = thinker->prev)->next = next;
+void P_RemoveThingDelayed(thinker_t *thinker)
+{
+    P_UnlinkThinker(thinker);
 
     mobj_t* thing = (mobj_t*)thinker;
 
-    if(thing->flags & MF_POOLED)
+    if(P_MobjPooled(thing))
+    {
+        // Free pool slots are chained through thinker.next.
         thing->type = MT_NOTHING;
+        thing->thinker.next = (thinker_t*)_g->thingFreeList;
+        _g->thingFreeList = thing;
+        _g->thingPoolUsed--;
+    }
     else
         Z_Free(thinker);
 }
@@ -134,9 +257,9 @@ void P_RemoveThingDelayed(thinker_t *thinker)
 // removed automatically as part of the thinker process.
 //
 
-void P_RemoveThinker(thinker_t *thinker)
+void P_RemoveThinker(thinker_t *thinker, thinkerpool_t pool)
 {
-  thinker->function = P_RemoveThinkerDelayed;
+  thinker->function = removethinkerdelayed[pool];
 }
 
 void P_RemoveThing(mobj_t *thing)
@@ -144,6 +267,121 @@ void P_RemoveThing(mobj_t *thing)
   thing->thinker.function = P_RemoveThingDelayed;
 }
 
+//
+// P_SleepThing
+//
+// Takes a mobj with nothing left to do off the thinker list.
+// It stays in its sector and blockmap lists, so it is still drawn,
+// touched and crushed; P_WakeThing puts it back when damage, a state
+// change or a moving sector needs it.
+//
+// A dormant_t holds its place in the list, so it wakes up where it
+// was and thinks in the same order as before: anything else would
+// change the order of P_Random calls and desync demos.
+//
+
+static void P_DormantThinker(thinker_t *thinker)
+{
+}
+
+static void P_InsertThinkerAfter(thinker_t *pos, thinker_t *thinker)
+{
+  thinker->prev = pos;
+  thinker->next = pos->next;
+  pos->next->prev = thinker;
+  pos->next = thinker;
+
+  // Landing just before the node P_RunThinkers runs next means it is
+  // after the one running now, so it gets its turn this tic.
+  if (_g->nextthinker && _g->nextthinker != &thinkercap && thinker->next == _g->nextthinker)
+    _g->nextthinker = thinker;
+}
+
+static dormant_t* P_NewDormant(mobj_t *first, mobj_t *last)
+{
+  dormant_t *d = P_NewThinker(tp_dormant);
+  mobj_t *mo;
+
+  d->thinker.function = P_DormantThinker;
+  d->first = first;
+  d->last = last;
+
+  for (mo = first; mo; mo = (mobj_t *)mo->thinker.next)
+    mo->thinker.prev = &d->thinker;
+
+  return d;
+}
+
+void P_SleepThing(mobj_t *thing)
+{
+  thinker_t *prev = thing->thinker.prev, *next = thing->thinker.next;
+
+  P_UnlinkThinker(&thing->thinker);
+
+  if (prev->function == P_DormantThinker)
+  {
+    // Join the run just before it.
+    dormant_t *d = (dormant_t *)prev;
+
+    thing->thinker.next = NULL;
+    d->last->thinker.next = &thing->thinker;
+    d->last = thing;
+    thing->thinker.prev = prev;
+  }
+  else if (next->function == P_DormantThinker)
+  {
+    // Or the one just after.
+    dormant_t *d = (dormant_t *)next;
+
+    thing->thinker.next = &d->first->thinker;
+    d->first = thing;
+    thing->thinker.prev = next;
+  }
+  else
+  {
+    thing->thinker.next = NULL;
+    P_InsertThinkerAfter(prev, &P_NewDormant(thing, thing)->thinker);
+  }
+
+  thing->flags |= MF_DORMANT;
+  _g->thingsDormant++;
+}
+
+void P_WakeThing(mobj_t *thing)
+{
+  dormant_t *d = (dormant_t *)thing->thinker.prev;
+  mobj_t *after = (mobj_t *)thing->thinker.next;
+  mobj_t *before = NULL, *mo;
+
+  for (mo = d->first; mo != thing; mo = (mobj_t *)mo->thinker.next)
+    before = mo;
+
+  if (!before)
+  {
+    // First of its run, it goes back in front of the placeholder.
+    P_InsertThinkerAfter(d->thinker.prev, &thing->thinker);
+
+    if (!(d->first = after))
+      P_RemoveThinker(&d->thinker, tp_dormant);
+  }
+  else
+  {
+    // Otherwise after it, and the rest of the run gets a new one.
+    mobj_t *last = d->last;
+
+    before->thinker.next = NULL;
+    d->last = before;
+
+    P_InsertThinkerAfter(&d->thinker, &thing->thinker);
+
+    if (after)
+      P_InsertThinkerAfter(&thing->thinker, &P_NewDormant(after, last)->thinker);
+  }
+
+  thing->flags &= ~MF_DORMANT;
+  _g->thingsDormant--;
+}
+
 
 /* cph 2002/01/13 - iterator for thinker list
  * WARNING: Do not modify thinkers between calls to this functin
@@ -194,7 +432,13 @@ void P_Ticker (void)
     if (_g->playeringame)
       P_PlayerThink(&_g->player);
 
+  unsigned int start = I_GetTimeMicros();
+
   P_RunThinkers();
+
+  _g->thinkertime += I_GetTimeMicros() - start;
+  _g->thinkertics++;
+
   P_UpdateSpecials();
   P_RespawnSpecials();
   P_MapEnd();
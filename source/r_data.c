@@ -99,14 +99,14 @@ static const texture_t* R_LoadTexture(int texture_num)
     const int *directory1, *directory2;
 
 
-    maptex1 = W_CacheLumpName("TEXTURE1");
+    maptex1 = W_CacheLumpNamePinned("TEXTURE1");
     numtextures1 = *maptex1;
     directory1 = maptex1+1;
 
 
     if (W_CheckNumForName("TEXTURE2") != -1)
     {
-        maptex2 = W_CacheLumpName("TEXTURE2");
+        maptex2 = W_CacheLumpNamePinned("TEXTURE2");
         numtextures2 = *maptex2;
         directory2 = maptex2+1;
     }
@@ -161,6 +161,8 @@ static const texture_t* R_LoadTexture(int texture_num)
         patch->patch = (const patch_t*)W_CacheLumpName(pname);
     }
 
+    W_UnlockLumpName("PNAMES");
+
     for (int j=0 ; j < texture->patchcount ; j++)
     {
         const texpatch_t* patch = &texture->patches[j];
@@ -221,6 +223,39 @@ const texture_t* R_GetTexture(int texture)
     return t;
 }
 
+//
+// R_UnlockTexturePatches
+// Compressed wall patches are locked while a texture refers to them.
+// Called before the level's textures are freed so the decompressed
+// patches become purgable.
+//
+void R_UnlockTexturePatches(void)
+{
+    if(!_g->lumpcache)
+        return;
+
+    const byte* pnames = (const byte*)W_CacheLumpName("PNAMES") + 4;
+
+    for(int i = 0; i < _g->numtextures; i++)
+    {
+        if(!textures[i])
+            continue;
+
+        // texture->name points at the maptexture_t it was built from.
+        const maptexture_t* mtexture = (const maptexture_t*)textures[i]->name;
+
+        for(int j = 0; j < mtexture->patchcount; j++)
+        {
+            char pname[8];
+            strncpy(pname, (const char*)&pnames[mtexture->patches[j].patch * 8], 8);
+
+            W_UnlockLumpName(pname);
+        }
+    }
+
+    W_UnlockLumpName("PNAMES");
+}
+
 static int R_GetTextureNumForName(const char* tex_name)
 {
     const int  *maptex1, *maptex2;
@@ -241,14 +276,14 @@ static int R_GetTextureNumForName(const char* tex_name)
         return _g->tex_lookup_last_num;
     }
 
-    maptex1 = W_CacheLumpName("TEXTURE1");
+    maptex1 = W_CacheLumpNamePinned("TEXTURE1");
     numtextures1 = *maptex1;
     directory1 = maptex1+1;
 
 
     if (W_CheckNumForName("TEXTURE2") != -1)
     {
-        maptex2 = W_CacheLumpName("TEXTURE2");
+        maptex2 = W_CacheLumpNamePinned("TEXTURE2");
         directory2 = maptex2+1;
     }
     else
@@ -312,14 +347,15 @@ int R_LoadTextureByName(const char* tex_name)
 
 static void R_InitTextures()
 {
-    const int* mtex1 = W_CacheLumpName("TEXTURE1");
+    // Pinned, texture names and R_UnlockTexturePatches point into them.
+    const int* mtex1 = W_CacheLumpNamePinned("TEXTURE1");
     int numtextures1 = *mtex1;
 
     int numtextures2 = 0;
 
     if (W_CheckNumForName("TEXTURE2") != -1)
     {
-        const int* mtex2 = W_CacheLumpName("TEXTURE2");
+        const int* mtex2 = W_CacheLumpNamePinned("TEXTURE2");
         numtextures2 = *mtex2;
     }
 
@@ -337,16 +373,90 @@ static void R_InitTextures()
         texturetranslation[i] = i;
 }
 
+static unsigned int R_FlatNameHash(const char* name)
+{
+  unsigned int h = 0;
+
+  for (int i = 0; i < 8 && name[i]; i++)
+    h = h * 31 + toupper(name[i]);
+
+  return (h * 2654435761u) >> (32 - _g->flathashbits);
+}
+
+static int R_CheckFlatNumForName(const char* name)
+{
+  int i = R_FlatNameHash(name);
+
+  for (; _g->flathash[i] != -1; i = (i + 1) & ((1 << _g->flathashbits) - 1))
+  {
+    const int flat = _g->flathash[i];
+
+    if (!strncasecmp(W_GetNameForNum(_g->flatlumps[flat]), name, 8))
+      return flat;
+  }
+
+  return -1;
+}
+
 //
 // R_InitFlats
 //
+// PWAD flats replace the IWAD flat of the same name in place,
+// so animation ranges stay intact, new ones are added at the end.
+//
+
 static void R_InitFlats(void)
 {
-  int i;
+  int i, f, first, last, count = 0;
+
+  for (f = 0; f < _g->numwadfiles; f++)
+    if (W_GetNamespace(f, 'F', &first, &last))
+      count += last - first + 1;
+
+  if (!count)
+    I_Error("R_InitFlats: No flats found");
+
+  _g->flatlumps = Z_Malloc(count*sizeof(*_g->flatlumps), PU_STATIC, 0);
+
+  // Open addressed, at most half full.
+  for (_g->flathashbits = 1; (1 << _g->flathashbits) < count * 2; _g->flathashbits++)
+    ;
+
+  _g->flathash = Z_Malloc((1 << _g->flathashbits)*sizeof(*_g->flathash), PU_STATIC, 0);
+
+  for (i = 0; i < (1 << _g->flathashbits); i++)
+    _g->flathash[i] = -1;
+
+  _g->numflats = 0;
+
+  for (f = 0; f < _g->numwadfiles; f++)
+  {
+    if (!W_GetNamespace(f, 'F', &first, &last))
+      continue;
 
-  _g->firstflat = W_GetNumForName("F_START") + 1;
-  int lastflat  = W_GetNumForName("F_END") - 1;
-  _g->numflats  = lastflat - _g->firstflat + 1;
+    for (i = first; i <= last; i++)
+    {
+      const char* name = W_GetNameForNum(i);
+      int flat = R_CheckFlatNumForName(name);
+
+      // The IWAD's own sub markers are kept so its numbering is unchanged.
+      if (f > 0 && !W_LumpLength(i))
+        continue;
+
+      if (flat == -1)
+      {
+        int h = R_FlatNameHash(name);
+
+        while (_g->flathash[h] != -1)
+          h = (h + 1) & ((1 << _g->flathashbits) - 1);
+
+        flat = _g->numflats++;
+        _g->flathash[h] = flat;
+      }
+
+      _g->flatlumps[flat] = i;
+    }
+  }
 
   // Create translation table for global animation.
   // killough 4/9/98: make column offsets 32-bit;
@@ -365,11 +475,29 @@ static void R_InitFlats(void)
 // so the sprite does not need to be cached completely
 // just for having the header info ready during rendering.
 //
+// Sprites of later wads are listed after the IWAD's so they win
+// in R_InitSpriteDefs.
+//
 static void R_InitSpriteLumps(void)
 {
-  _g->firstspritelump = W_GetNumForName("S_START") + 1;
-  _g->lastspritelump = W_GetNumForName("S_END") - 1;
-  _g->numspritelumps = _g->lastspritelump - _g->firstspritelump + 1;
+  int i, f, first, last, count = 0;
+
+  for (f = 0; f < _g->numwadfiles; f++)
+    if (W_GetNamespace(f, 'S', &first, &last))
+      count += last - first + 1;
+
+  _g->spritelumps = Z_Malloc(count*sizeof(*_g->spritelumps), PU_STATIC, 0);
+  _g->numspritelumps = 0;
+
+  for (f = 0; f < _g->numwadfiles; f++)
+  {
+    if (!W_GetNamespace(f, 'S', &first, &last))
+      continue;
+
+    for (i = first; i <= last; i++)
+      if (f == 0 || W_LumpLength(i))
+        _g->spritelumps[_g->numspritelumps++] = i;
+  }
 }
 
 //
@@ -378,7 +506,7 @@ static void R_InitSpriteLumps(void)
 void R_InitColormaps (void)
 {
     int lump = W_GetNumForName("COLORMAP");
-    colormaps = W_CacheLumpNum(lump);
+    colormaps = W_CacheLumpNumPinned(lump);
 }
 
 //
@@ -409,11 +537,11 @@ void R_InitData(void)
 
 int R_FlatNumForName(const char *name)    // killough -- const added
 {
-  int i = W_CheckNumForName(name);
+  int i = R_CheckFlatNumForName(name);
 
   if (i == -1)
     I_Error("R_FlatNumForName: %.8s not found", name);
-  return i - _g->firstflat;
+  return i;
 }
 
 //
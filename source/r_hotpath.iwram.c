@@ -42,6 +42,8 @@
 #include "config.h"
 #endif
 
+#include <stdint.h>
+
 #ifndef GBA
     #include <time.h>
 #endif
@@ -70,6 +72,21 @@
 #include "hardware/timer.h"
 #endif
 
+// Span and column texture addressing on the SIO interpolator. RP2040
+// builds use the hardware; other builds can define INTERP_KERNELS to
+// run the same kernels on the software model.
+#if defined(RP2040) && !defined(NO_INTERP_KERNELS)
+#define INTERP_KERNELS
+#endif
+
+#ifdef INTERP_KERNELS
+#include "r_interp.h"
+
+#ifndef RP2040
+r_interp_t r_interpmodel;
+#endif
+#endif
+
 
 //#define static
 
@@ -120,10 +137,10 @@ const angle_t* xtoviewangle_vram = (const angle_t*)&vram1_spare[580+480];
 //240 Bytes.
 short* wipe_y_lookup = (short*)&vram1_spare[580+480+484];
 
-//384 Bytes
+//776 Bytes, the rest of it.
 vissprite_t** vissprite_ptrs = (vissprite_t**)&vram1_spare[580+480+484+240];
 
-//2168 bytes used. 392 bytes left.
+#define MAXVISSPRITES ((2560-(580+480+484+240)) / sizeof(vissprite_t*))
 
 
 //Stuff alloc'd in VRAM2 memory.
@@ -176,6 +193,14 @@ static sector_t  *frontsector;
 static sector_t  *backsector;
 static drawseg_t *ds_p;
 
+// Drawsegs that can clip sprites, one bit per drawseg, for each
+// 16 column stretch of the screen. See R_BucketDrawSegs.
+#define DSBUCKETSHIFT   4
+#define DSBUCKETS       ((MAX_SCREENWIDTH + (1 << DSBUCKETSHIFT) - 1) >> DSBUCKETSHIFT)
+#define DSWORDS         ((MAXDRAWSEGS + 31) / 32)
+
+static unsigned int dsbuckets[DSBUCKETS][DSWORDS];
+
 static visplane_t *floorplane, *ceilingplane;
 static int             rw_angle1;
 
@@ -248,8 +273,16 @@ static fixed_t  pixlowstep;
 static int      worldhigh;
 static int      worldlow;
 
-static lighttable_t current_colormap[256];
-static const lighttable_t* current_colormap_ptr;
+// Colormaps copied into fast RAM, see R_LoadColorMap.
+#ifndef COLORMAPSLOTS
+#define COLORMAPSLOTS 8
+#endif
+
+static lighttable_t colormapslots[COLORMAPSLOTS][256];
+static const lighttable_t* colormapslotsrc[COLORMAPSLOTS];
+static unsigned int colormapslotused[COLORMAPSLOTS];
+static unsigned int colormapclock;
+static int lastcolormapslot;
 
 static fixed_t planeheight;
 
@@ -514,17 +547,45 @@ static const lighttable_t* R_ColourMap(int lightlevel)
 
 
 //Load a colormap into IWRAM.
-static const lighttable_t* R_LoadColorMap(int lightlevel)
+//The last COLORMAPSLOTS maps used are kept, so walls, planes and sprites
+//at a few alternating light levels don't copy the same maps each time.
+static const lighttable_t* R_CacheColorMap(const lighttable_t* lm)
 {
-    const lighttable_t* lm = R_ColourMap(lightlevel);
+    if(colormapslotsrc[lastcolormapslot] == lm)
+        return colormapslots[lastcolormapslot];
+
+    int slot = 0;
 
-    if(current_colormap_ptr != lm)
+    for(int i = 0; i < COLORMAPSLOTS; i++)
     {
-        BlockCopy(current_colormap, lm, 256);
-        current_colormap_ptr = lm;
+        if(colormapslotsrc[i] == lm)
+        {
+            slot = i;
+            break;
+        }
+
+        // Least recently used, an empty slot never was.
+        if(colormapslotused[i] < colormapslotused[slot])
+            slot = i;
     }
 
-    return current_colormap;
+    if(colormapslotsrc[slot] != lm)
+    {
+        BlockCopy(colormapslots[slot], lm, 256);
+        colormapslotsrc[slot] = lm;
+
+        _g->colormapcopies++;
+    }
+
+    colormapslotused[slot] = ++colormapclock;
+    lastcolormapslot = slot;
+
+    return colormapslots[slot];
+}
+
+static const lighttable_t* R_LoadColorMap(int lightlevel)
+{
+    return R_CacheColorMap(R_ColourMap(lightlevel));
 }
 
 //
@@ -554,6 +615,8 @@ inline static void R_DrawColumnPixel(unsigned short* dest, const byte* source, c
 #endif
 }
 
+#ifndef INTERP_KERNELS
+
 static void R_DrawColumn (const draw_column_vars_t *dcvars)
 {
     int count = (dcvars->yh - dcvars->yl) + 1;
@@ -620,6 +683,138 @@ static void R_DrawColumn (const draw_column_vars_t *dcvars)
         case 1:     R_DrawColumnPixel(dest, source, colormap, frac);
     }
 }
+#else
+
+inline static void R_DrawTexelPixel(unsigned short* dest, const byte* colormap, r_interp_t* interp)
+{
+    pixel* d = (pixel*)dest;
+
+    const byte* texel = (const byte*)R_InterpPopFull(interp);
+
+#ifdef GBA
+    *d = colormap[*texel];
+#else
+    unsigned int color = colormap[*texel];
+
+    *d = (color | (color << 8));
+#endif
+}
+
+static void R_DrawColumn (const draw_column_vars_t *dcvars)
+{
+    int count = (dcvars->yh - dcvars->yl) + 1;
+
+    // Zero length, column does not exceed a pixel.
+    if (count <= 0)
+        return;
+
+    const byte *colormap = dcvars->colormap;
+
+    unsigned short* dest = drawvars.byte_topleft + ScreenYToOffset(dcvars->yl) + dcvars->x;
+
+    const unsigned int fracstep = (dcvars->iscale << COLEXTRABITS);
+    const unsigned int frac = (dcvars->texturemid + (dcvars->yl - centery)*dcvars->iscale) << COLEXTRABITS;
+
+    // Lane 0 steps frac and hands out its top bits as the texel
+    // offset, lane 1 adds nothing.
+    r_interp_t* interp = R_INTERP;
+
+    interp->ctrl[0] = INTERP_CTRL(COLBITS, 0, 31 - COLBITS, INTERP_ADD_RAW);
+    interp->ctrl[1] = INTERP_CTRL(0, 0, 0, 0);
+    interp->accum[0] = frac;
+    interp->accum[1] = 0;
+    interp->base[0] = fracstep;
+    interp->base[1] = 0;
+    interp->base[2] = (uintptr_t)dcvars->source;
+
+    unsigned int l = (count >> 4);
+
+    while(l--)
+    {
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+    }
+
+    unsigned int r = (count & 15);
+
+    switch(r)
+    {
+        case 15:    R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 14:    R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 13:    R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 12:    R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 11:    R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 10:    R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 9:     R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 8:     R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 7:     R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 6:     R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 5:     R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 4:     R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 3:     R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 2:     R_DrawTexelPixel(dest, colormap, interp); dest+=SCREENWIDTH;
+        case 1:     R_DrawTexelPixel(dest, colormap, interp);
+    }
+}
+
+#endif
+
+//
+// R_DrawColumnShort
+// Columns shorter than SHORTCOLUMN pixels. A plain loop costs less
+// here than the unrolled kernel's setup and jump into the tail.
+//
+#define SHORTCOLUMN 8
+
+static void R_DrawColumnShort(const draw_column_vars_t *dcvars)
+{
+    int count = (dcvars->yh - dcvars->yl) + 1;
+
+    const byte *source = dcvars->source;
+    const byte *colormap = dcvars->colormap;
+
+    unsigned short* dest = drawvars.byte_topleft + ScreenYToOffset(dcvars->yl) + dcvars->x;
+
+    const unsigned int fracstep = (dcvars->iscale << COLEXTRABITS);
+    unsigned int frac = (dcvars->texturemid + (dcvars->yl - centery)*dcvars->iscale) << COLEXTRABITS;
+
+    while(count-- > 0)
+    {
+        R_DrawColumnPixel(dest, source, colormap, frac); dest+=SCREENWIDTH; frac+=fracstep;
+    }
+}
+
+//
+// R_DrawWallColumn
+// Picks the column kernel for solid walls and the sky by length.
+// Every texture height already wraps at 128 through the shift in
+// R_DrawColumnPixel, as vanilla's &127 did, so height needs no
+// kernel of its own.
+//
+inline static void R_DrawWallColumn(const draw_column_vars_t *dcvars)
+{
+    if (dcvars->yh - dcvars->yl < SHORTCOLUMN - 1)
+        R_DrawColumnShort(dcvars);
+    else
+        R_DrawColumn(dcvars);
+}
 
 static void R_DrawColumnHiRes(const draw_column_vars_t *dcvars)
 {
@@ -1038,12 +1233,37 @@ static void R_DrawSprite (const vissprite_t* spr)
     // (pointer check was originally nonportable
     // and buggy, by going past LEFT end of array):
 
+    // Only the drawsegs in the buckets the sprite spans are looked
+    // at, still from end to start.
+
     const drawseg_t* drawsegs  =_g->drawsegs;
 
-    for (const drawseg_t* ds = ds_p; ds-- > drawsegs; )  // new -- killough
+    unsigned int dsmask[DSWORDS];
+
+    const int b1 = spr->x1 >> DSBUCKETSHIFT;
+    const int b2 = spr->x2 >> DSBUCKETSHIFT;
+
+    for (int w = 0; w < DSWORDS; w++)
+    {
+        unsigned int bits = 0;
+
+        for (int b = b1; b <= b2; b++)
+            bits |= dsbuckets[b][w];
+
+        dsmask[w] = bits;
+    }
+
+    for (int w = DSWORDS; w-- > 0; )
+    for (unsigned int bits = dsmask[w]; bits; )
     {
+        const int i = 31 - __builtin_clz(bits);
+
+        bits &= ~(1u << i);
+
+        const drawseg_t* ds = &drawsegs[w * 32 + i];
+
         // determine if the drawseg obscures the sprite
-        if (ds->x1 > spr->x2 || ds->x2 < spr->x1 || (!ds->silhouette && !ds->maskedtexturecol))
+        if (ds->x1 > spr->x2 || ds->x2 < spr->x1)
             continue;      // does not cover sprite
 
         const int r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
@@ -1122,7 +1342,8 @@ static void R_DrawPSprite (pspdef_t *psp, int lightlevel)
 
     flip = (boolean) SPR_FLIPPED(sprframe, 0);
 
-    const patch_t* patch = W_CacheLumpNum(sprframe->lump[0]+_g->firstspritelump);
+    const int lump = _g->spritelumps[sprframe->lump[0]];
+    const patch_t* patch = W_CacheLumpNum(lump);
     // calculate edges of the shape
     fixed_t       tx;
     tx = psp->sx-160*FRACUNIT;
@@ -1140,7 +1361,10 @@ static void R_DrawPSprite (pspdef_t *psp, int lightlevel)
 
     // off the side
     if (x2 < 0 || x1 > SCREENWIDTH)
+    {
+        W_UnlockLumpNum(lump);
         return;
+    }
 
     // store information in a vissprite
     vis = &avis;
@@ -1180,6 +1404,8 @@ static void R_DrawPSprite (pspdef_t *psp, int lightlevel)
         vis->colormap = R_LoadColorMap(lightlevel);  // local light
 
     R_DrawVisSprite(vis);
+
+    W_UnlockLumpNum(lump);
 }
 
 
@@ -1211,24 +1437,52 @@ static void R_DrawPlayerSprites(void)
 // Rewritten by Lee Killough to avoid using unnecessary
 // linked lists, and to use faster sorting algorithm.
 //
-static int compare (const void* l, const void* r)
+// Nearest first, by scale. The BSP walk projects sprites roughly
+// front to back already, so an insertion sort has little to move
+// and saves qsort's call through a pointer for every compare.
+//
+static void R_SortVisSprites (void)
 {
-    const vissprite_t* vl = *(const vissprite_t**)l;
-    const vissprite_t* vr = *(const vissprite_t**)r;
+    const int count = num_vissprite;
+
+    // R_NewVisSprite left them in vissprite_ptrs in projection order.
+    for (int i = 0; i < count; i++)
+    {
+        vissprite_t* vis = vissprite_ptrs[i];
+        const fixed_t scale = vis->scale;
+
+        int j = i;
 
-    return vr->scale - vl->scale;
+        for ( ; j > 0 && vissprite_ptrs[j-1]->scale < scale; j--)
+            vissprite_ptrs[j] = vissprite_ptrs[j-1];
+
+        vissprite_ptrs[j] = vis;
+    }
 }
 
-static void R_SortVisSprites (void)
+//
+// R_BucketDrawSegs
+// Marks every drawseg with a silhouette or a masked texture in the
+// buckets of the columns it covers, so R_DrawSprite skips the ones
+// that can't overlap its sprite without testing them one by one.
+//
+
+static void R_BucketDrawSegs(void)
 {
-    int i = num_vissprite;
+    const drawseg_t* drawsegs = _g->drawsegs;
+
+    memset(dsbuckets, 0, sizeof(dsbuckets));
 
-    if (i)
+    for (const drawseg_t* ds = drawsegs; ds < ds_p; ds++)
     {
-        while (--i>=0)
-            vissprite_ptrs[i] = _g->vissprites+i;
+        if (!ds->silhouette && !ds->maskedtexturecol)
+            continue;
 
-        qsort(vissprite_ptrs, num_vissprite, sizeof (vissprite_t*), compare);
+        const int i = ds - drawsegs;
+        const unsigned int bit = 1u << (i & 31);
+
+        for (int b = ds->x1 >> DSBUCKETSHIFT; b <= ds->x2 >> DSBUCKETSHIFT; b++)
+            dsbuckets[b][i >> 5] |= bit;
     }
 }
 
@@ -1245,9 +1499,15 @@ static void R_DrawMasked(void)
 
     R_SortVisSprites();
 
+    if (num_vissprite)
+        R_BucketDrawSegs();
+
     // draw all vissprites back to front
     for (i = num_vissprite ;--i>=0; )
+    {
         R_DrawSprite(vissprite_ptrs[i]);         // killough
+        W_UnlockLumpNum(vissprite_ptrs[i]->lump);
+    }
 
     // render any remaining masked mid textures
 
@@ -1292,6 +1552,8 @@ inline static void R_DrawSpanPixel(unsigned short* dest, const byte* source, con
 #endif
 }
 
+#ifndef INTERP_KERNELS
+
 static void R_DrawSpan(unsigned int y, unsigned int x1, unsigned int x2, const draw_span_vars_t *dsvars)
 {
     unsigned int count = (x2 - x1);
@@ -1350,6 +1612,77 @@ static void R_DrawSpan(unsigned int y, unsigned int x1, unsigned int x2, const d
         case 1:     R_DrawSpanPixel(dest, source, colormap, position);
     }
 }
+#else
+
+static void R_DrawSpan(unsigned int y, unsigned int x1, unsigned int x2, const draw_span_vars_t *dsvars)
+{
+    unsigned int count = (x2 - x1);
+
+    const byte *colormap = dsvars->colormap;
+
+    unsigned short* dest = drawvars.byte_topleft + ScreenYToOffset(y) + x1;
+
+    // Lane 0 steps the packed position and hands out x, lane 1 reads
+    // lane 0 and hands out y*64. Stepping with one 32 bit add keeps
+    // the carry from y into x that the shift and mask loop has.
+    r_interp_t* interp = R_INTERP;
+
+    interp->ctrl[0] = INTERP_CTRL(26, 0, 5, INTERP_ADD_RAW);
+    interp->ctrl[1] = INTERP_CTRL(4, 6, 11, INTERP_CROSS_INPUT);
+    interp->accum[0] = dsvars->position;
+    interp->accum[1] = 0;
+    interp->base[0] = dsvars->step;
+    interp->base[1] = 0;
+    interp->base[2] = (uintptr_t)dsvars->source;
+
+    unsigned int l = (count >> 4);
+
+    while(l--)
+    {
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+        R_DrawTexelPixel(dest, colormap, interp); dest++;
+    }
+
+    unsigned int r = (count & 15);
+
+    switch(r)
+    {
+        case 15:    R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 14:    R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 13:    R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 12:    R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 11:    R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 10:    R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 9:     R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 8:     R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 7:     R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 6:     R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 5:     R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 4:     R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 3:     R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 2:     R_DrawTexelPixel(dest, colormap, interp); dest++;
+        case 1:     R_DrawTexelPixel(dest, colormap, interp);
+    }
+}
+
+#endif
 
 #pragma GCC pop_options
 
@@ -1393,66 +1726,68 @@ static void R_MakeSpans(int x, unsigned int t1, unsigned int b1, unsigned int t2
 
 // New function, by Lee Killough
 
-static void R_DoDrawPlane(visplane_t *pl)
+static void R_DrawSkyPlane(const visplane_t *pl)
 {
     register int x;
     draw_column_vars_t dcvars;
 
     R_SetDefaultDrawColumnVars(&dcvars);
 
-    if (pl->minx <= pl->maxx)
-    {
-        if (pl->picnum == _g->skyflatnum)
-        { // sky flat
+    // Normal Doom sky, only one allowed per level
+    dcvars.texturemid = skytexturemid;    // Default y-offset
 
-            // Normal Doom sky, only one allowed per level
-            dcvars.texturemid = skytexturemid;    // Default y-offset
+    /* Sky is always drawn full bright, i.e. colormaps[0] is used.
+     * Because of this hack, sky is not affected by INVUL inverse mapping.
+     * Until Boom fixed this. Compat option added in MBF. */
 
-          /* Sky is always drawn full bright, i.e. colormaps[0] is used.
-           * Because of this hack, sky is not affected by INVUL inverse mapping.
-           * Until Boom fixed this. Compat option added in MBF. */
+    // Copied to fast RAM like the wall and flat maps.
+    if (!(dcvars.colormap = fixedcolormap))
+        dcvars.colormap = fullcolormap;          // killough 3/20/98
 
-            if (!(dcvars.colormap = fixedcolormap))
-                dcvars.colormap = fullcolormap;          // killough 3/20/98
+    dcvars.colormap = R_CacheColorMap(dcvars.colormap);
 
-            // proff 09/21/98: Changed for high-res
-            dcvars.iscale = skyiscale;
+    // proff 09/21/98: Changed for high-res
+    dcvars.iscale = skyiscale;
 
-            const texture_t* tex = R_GetOrLoadTexture(_g->skytexture);
+    const texture_t* tex = R_GetOrLoadTexture(_g->skytexture);
 
-            // killough 10/98: Use sky scrolling offset
-            for (x = pl->minx; (dcvars.x = x) <= pl->maxx; x++)
-            {
-                if ((dcvars.yl = pl->top[x]) != -1 && dcvars.yl <= (dcvars.yh = pl->bottom[x])) // dropoff overflow
-                {
-                    int xc = ((viewangle + xtoviewangle[x]) >> ANGLETOSKYSHIFT);
+    // killough 10/98: Use sky scrolling offset
+    for (x = pl->minx; (dcvars.x = x) <= pl->maxx; x++)
+    {
+        if ((dcvars.yl = pl->top[x]) != -1 && dcvars.yl <= (dcvars.yh = pl->bottom[x])) // dropoff overflow
+        {
+            int xc = ((viewangle + xtoviewangle[x]) >> ANGLETOSKYSHIFT);
 
-                    const column_t* column = R_GetColumn(tex, xc);
+            const column_t* column = R_GetColumn(tex, xc);
 
-                    dcvars.source = (const byte*)column + 3;
-                    R_DrawColumn(&dcvars);
-                }
-            }
+            dcvars.source = (const byte*)column + 3;
+            R_DrawWallColumn(&dcvars);
         }
-        else
-        {     // regular flat
+    }
+}
 
-            draw_span_vars_t dsvars;
+//
+// R_DrawFlatPlane
+// The flat's lump is cached by the caller, so planes that share it
+// can be drawn one after another with a single lookup.
+//
+static void R_DrawFlatPlane(visplane_t *pl, const byte *source)
+{
+    register int x;
+    draw_span_vars_t dsvars;
 
-            dsvars.source = W_CacheLumpNum(_g->firstflat + flattranslation[pl->picnum]);
-            dsvars.colormap = R_LoadColorMap(pl->lightlevel);
+    dsvars.source = source;
+    dsvars.colormap = R_LoadColorMap(pl->lightlevel);
 
-            planeheight = D_abs(pl->height-viewz);
+    planeheight = D_abs(pl->height-viewz);
 
-            const int stop = pl->maxx + 1;
+    const int stop = pl->maxx + 1;
 
-            pl->top[pl->minx-1] = pl->top[stop] = 0xff; // dropoff overflow
+    pl->top[pl->minx-1] = pl->top[stop] = 0xff; // dropoff overflow
 
-            for (x = pl->minx ; x <= stop ; x++)
-            {
-                R_MakeSpans(x,pl->top[x-1],pl->bottom[x-1], pl->top[x],pl->bottom[x], &dsvars);
-            }
-        }
+    for (x = pl->minx ; x <= stop ; x++)
+    {
+        R_MakeSpans(x,pl->top[x-1],pl->bottom[x-1], pl->top[x],pl->bottom[x], &dsvars);
     }
 }
 
@@ -1489,17 +1824,27 @@ static fixed_t R_ScaleFromGlobalAngle(angle_t visangle)
 //
 // R_NewVisSprite
 //
+// Vissprites are taken from the end of the render arena, below the
+// openings. Only vissprite_ptrs keeps track of them.
+//
 static vissprite_t *R_NewVisSprite(void)
 {
-    if (num_vissprite >= MAXVISSPRITES)
+    byte* p = (byte*)_g->lastopening - sizeof(vissprite_t);
+
+    p -= (uintptr_t)p & (__alignof__(vissprite_t) - 1);
+
+    if (num_vissprite >= MAXVISSPRITES || p < (byte*)ds_p)
     {
+        _g->visspriteoverflows++;
 #ifdef RANGECHECK
         I_Error("Vissprite overflow.");
 #endif
         return NULL;
     }
 
-    return _g->vissprites + num_vissprite++;
+    _g->lastopening = (short*)p;
+
+    return vissprite_ptrs[num_vissprite++] = (vissprite_t*)p;
 }
 
 
@@ -1547,7 +1892,8 @@ static void R_ProjectSprite (mobj_t* thing, int lightlevel)
     }
 
     const boolean flip = (boolean)SPR_FLIPPED(sprframe, rot);
-    const patch_t* patch = W_CacheLumpNum(sprframe->lump[rot] + _g->firstspritelump);
+    const int lump = _g->spritelumps[sprframe->lump[rot]];
+    const patch_t* patch = W_CacheLumpNum(lump);
 
     /* calculate edges of the shape
      * cph 2003/08/1 - fraggle points out that this offset must be flipped
@@ -1561,20 +1907,14 @@ static void R_ProjectSprite (mobj_t* thing, int lightlevel)
 
     fixed_t xl = (centerxfrac + FixedMul(tx,xscale));
 
-    // off the side?
-    if(xl > (SCREENWIDTH << FRACBITS))
-        return;
-
     fixed_t xr = (centerxfrac + FixedMul(tx + (patch->width << FRACBITS),xscale)) - FRACUNIT;
 
-    // off the side?
-    if(xr < 0)
-        return;
-
-    //Too small.
-    if(xr <= (xl + (FRACUNIT >> 2)))
+    // off the side? Too small?
+    if((xl > (SCREENWIDTH << FRACBITS)) || (xr < 0) || (xr <= (xl + (FRACUNIT >> 2))))
+    {
+        W_UnlockLumpNum(lump);
         return;
-
+    }
 
     const int x1 = (xl >> FRACBITS);
     const int x2 = (xr >> FRACBITS);
@@ -1584,13 +1924,17 @@ static void R_ProjectSprite (mobj_t* thing, int lightlevel)
 
     //No more vissprites.
     if(!vis)
+    {
+        W_UnlockLumpNum(lump);
         return;
+    }
 
     vis->mobjflags = thing->flags;
     // proff 11/06/98: Changed for high-res
     vis->scale = FixedDiv(projectiony, tz);
     vis->iscale = tz >> 7;
     vis->patch = patch;
+    vis->lump = lump;
     vis->gx = fx;
     vis->gy = fy;
     vis->gz = fz;
@@ -1663,25 +2007,103 @@ static void R_AddSprites(subsector_t* subsec, int lightlevel)
 
 
 // New function, by Lee Killough
+//
+// Narrow and wide planes have a free list each. R_ClearPlanes puts
+// every plane back on its list at the start of the frame.
 
-static visplane_t *new_visplane(unsigned hash)
+static visplane_t *new_visplane(unsigned hash, boolean wide)
 {
-    visplane_t *check = _g->freetail;
+    visplane_t *check = _g->freeplanes[wide];
 
     if (!check)
-        check = Z_Calloc(1, sizeof(visplane_t), PU_LEVEL, NULL);
-    else
     {
-        if (!(_g->freetail = _g->freetail->next))
-            _g->freehead = &_g->freetail;
+        const int width = wide ? SCREENWIDTH : VISPLANENARROW;
+
+        // Pads around the top and bottom columns keep both word aligned.
+        check = Z_Malloc(sizeof(visplane_t) + 4 + width + 4 + width + 4, PU_LEVEL, NULL);
+        check->width = width;
     }
+    else
+        _g->freeplanes[wide] = check->next;
 
     check->next = _g->visplanes[hash];
     _g->visplanes[hash] = check;
 
+    _g->numvisplanes++;
+
     return check;
 }
 
+//
+// R_SetPlaneBase
+// Points the plane's columns at screen x base onwards.
+//
+static void R_SetPlaneBase(visplane_t *pl, int base)
+{
+    byte* data = (byte*)(pl + 1);
+
+    pl->base = base;
+    pl->top = data + 4 - base;
+    pl->bottom = data + 4 + pl->width + 4 - base;
+}
+
+//
+// R_InitPlaneColumns
+// Gives an empty plane its columns from base on, all unmarked.
+// The block is reused from earlier frames, so bottom and the pads
+// are cleared too: R_MakeSpans reads them at unmarked columns and
+// stale 0xff bytes there would give it a span on row 255.
+//
+static void R_InitPlaneColumns(visplane_t *pl, int base)
+{
+    if (base > SCREENWIDTH - pl->width)
+        base = SCREENWIDTH - pl->width;
+
+    R_SetPlaneBase(pl, base);
+
+    BlockSet(pl + 1, 0, 4 + pl->width + 4 + pl->width + 4);
+    BlockSet(pl->top + base, UINT_MAX, pl->width);
+}
+
+//
+// R_WidenPlane
+// Moves a narrow plane that has outgrown its columns to a wide one.
+// The narrow one is left empty in the hash chain until the frame ends.
+//
+static visplane_t *R_WidenPlane(visplane_t *pl)
+{
+    visplane_t *wide = new_visplane(visplane_hash(pl->picnum, pl->lightlevel, pl->height), true);
+
+    wide->height = pl->height;
+    wide->picnum = pl->picnum;
+    wide->lightlevel = pl->lightlevel;
+    wide->minx = pl->minx;
+    wide->maxx = pl->maxx;
+    wide->modified = pl->modified;
+
+    R_InitPlaneColumns(wide, 0);
+
+    for (int x = pl->minx; x <= pl->maxx; x++)
+    {
+        wide->top[x] = pl->top[x];
+        wide->bottom[x] = pl->bottom[x];
+    }
+
+    pl->minx = SCREENWIDTH;
+    pl->maxx = -1;
+    pl->modified = false;
+
+    R_InitPlaneColumns(pl, pl->base);
+
+    if (floorplane == pl)
+        floorplane = wide;
+
+    if (ceilingplane == pl)
+        ceilingplane = wide;
+
+    return wide;
+}
+
 static visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel)
 {
     visplane_t *check;
@@ -1699,7 +2121,7 @@ static visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel)
                 lightlevel == check->lightlevel)
             return check;
 
-    check = new_visplane(hash);         // killough
+    check = new_visplane(hash, false);         // killough
 
     check->height = height;
     check->picnum = picnum;
@@ -1707,7 +2129,7 @@ static visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel)
     check->minx = SCREENWIDTH; // Was SCREENWIDTH -- killough 11/98
     check->maxx = -1;
 
-    BlockSet(check->top, UINT_MAX, sizeof(check->top));
+    R_InitPlaneColumns(check, 0);
 
     check->modified = false;
 
@@ -1722,7 +2144,7 @@ static visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel)
 static visplane_t *R_DupPlane(const visplane_t *pl, int start, int stop)
 {
     unsigned hash = visplane_hash(pl->picnum, pl->lightlevel, pl->height);
-    visplane_t *new_pl = new_visplane(hash);
+    visplane_t *new_pl = new_visplane(hash, stop - start >= VISPLANENARROW);
 
     new_pl->height = pl->height;
     new_pl->picnum = pl->picnum;
@@ -1730,39 +2152,101 @@ static visplane_t *R_DupPlane(const visplane_t *pl, int start, int stop)
     new_pl->minx = start;
     new_pl->maxx = stop;
 
-    BlockSet(new_pl->top, UINT_MAX, sizeof(new_pl->top));
+    R_InitPlaneColumns(new_pl, start);
 
     new_pl->modified = false;
 
     return new_pl;
 }
 
+//
+// R_PlaneColumnsFree
+// True if none of columns start to stop is marked in the plane yet.
+//
+static boolean R_PlaneColumnsFree(const visplane_t *pl, int start, int stop)
+{
+    const int intrl = start > pl->minx ? start : pl->minx;
+    const int intrh = stop < pl->maxx ? stop : pl->maxx;
+
+    int x;
+
+    for (x=intrl ; x <= intrh && pl->top[x] == 0xff; x++) // dropoff overflow
+        ;
+
+    return x > intrh;
+}
+
+//
+// R_ExtendPlane
+// Widens the plane's range to take in start to stop. An empty plane
+// moves its columns there first, a narrow one that can't reach is
+// swapped for a wide one.
+//
+static visplane_t *R_ExtendPlane(visplane_t *pl, int start, int stop)
+{
+    int unionl = start, unionh = stop;
+
+    if (pl->minx > pl->maxx)
+    {
+        // Still all unmarked, only the base moves.
+        R_SetPlaneBase(pl, start < SCREENWIDTH - pl->width ? start : SCREENWIDTH - pl->width);
+    }
+    else
+    {
+        if (pl->minx < unionl)
+            unionl = pl->minx;
+
+        if (pl->maxx > unionh)
+            unionh = pl->maxx;
+    }
+
+    if (unionl < pl->base || unionh >= pl->base + pl->width)
+        pl = R_WidenPlane(pl);
+
+    pl->minx = unionl;
+    pl->maxx = unionh;
+
+    return pl;
+}
 
 //
 // R_CheckPlane
 //
+// Planes with the same height, pic and light can share a visplane_t
+// as long as their columns don't overlap. If pl's columns are taken,
+// another such plane with room is used before making a new one.
+//
 static visplane_t *R_CheckPlane(visplane_t *pl, int start, int stop)
 {
-    int intrl, intrh, unionl, unionh, x;
+    if (R_PlaneColumnsFree(pl, start, stop)) /* Can use existing plane; extend range */
+        return R_ExtendPlane(pl, start, stop);
 
-    if (start < pl->minx)
-        intrl   = pl->minx, unionl = start;
-    else
-        unionl  = pl->minx,  intrl = start;
+    for (visplane_t *check = _g->visplanes[visplane_hash(pl->picnum, pl->lightlevel, pl->height)]; check; check = check->next)
+    {
+        // Not the other plane of this wall, it is marked alongside.
+        if (check == floorplane || check == ceilingplane)
+            continue;
 
-    if (stop  > pl->maxx)
-        intrh   = pl->maxx, unionh = stop;
-    else
-        unionh  = pl->maxx, intrh  = stop;
+        if (check->height != pl->height || check->picnum != pl->picnum || check->lightlevel != pl->lightlevel)
+            continue;
 
-    for (x=intrl ; x <= intrh && pl->top[x] == 0xff; x++) // dropoff overflow
-        ;
+        // Only if it fits without widening, else a new plane is cheaper.
+        const int unionl = check->minx < start ? check->minx : start;
+        const int unionh = check->maxx > stop ? check->maxx : stop;
+
+        if (check->minx <= check->maxx &&
+            (unionl < check->base || unionh >= check->base + check->width))
+            continue;
+
+        if (check->minx > check->maxx && stop - start >= check->width)
+            continue;
+
+        if (R_PlaneColumnsFree(check, start, stop))
+            return R_ExtendPlane(check, start, stop);
+    }
 
-    if (x > intrh) { /* Can use existing plane; extend range */
-        pl->minx = unionl; pl->maxx = unionh;
-        return pl;
-    } else /* Cannot use existing plane; create a new one */
-        return R_DupPlane(pl,start,stop);
+    /* Cannot use existing plane; create a new one */
+    return R_DupPlane(pl,start,stop);
 }
 
 static void R_DrawColumnInCache(const column_t* patch, byte* cache, int originy, int cacheheight)
@@ -1928,7 +2412,7 @@ static void R_DrawSegTextureColumn(unsigned int texture, int texcolumn, draw_col
         dcvars->source = R_ComposeColumn(texture, tex, texcolumn, dcvars->iscale);
     }
 
-    R_DrawColumn (dcvars);
+    R_DrawWallColumn (dcvars);
 }
 
 //
@@ -2114,17 +2598,24 @@ static void R_RenderSegLoop (int rw_x)
     }
 }
 
+// Openings go down from lastopening and must stay clear of the
+// drawseg being filled in at ds_p.
+//
 static boolean R_CheckOpenings(const int start)
 {
-    int pos = _g->lastopening - _g->openings;
-    int need = (rw_stopx - start)*4 + pos;
+    int room = (byte*)_g->lastopening - (byte*)(ds_p + 1);
+    int need = (rw_stopx - start)*4*sizeof(short);
+
+    if(need <= room)
+        return true;
+
+    _g->openingoverflows++;
 
 #ifdef RANGECHECK
-    if(need > MAXOPENINGS)
-        I_Error("Openings overflow. Need = %d", need);
+    I_Error("Openings overflow. Need = %d", need);
 #endif
 
-    return need <= MAXOPENINGS;
+    return false;
 }
 
 //
@@ -2138,8 +2629,9 @@ static void R_StoreWallRange(const int start, const int stop)
     angle_t offsetangle;
 
     // don't overflow and crash
-    if (ds_p == &_g->drawsegs[MAXDRAWSEGS])
+    if ((byte*)(ds_p + 1) > (byte*)_g->lastopening)
     {
+        _g->drawsegoverflows++;
 #ifdef RANGECHECK
         I_Error("Drawsegs overflow.");
 #endif
@@ -2311,8 +2803,8 @@ static void R_StoreWallRange(const int start, const int stop)
         if (sidedef->midtexture)    // masked midtexture
         {
             maskedtexture = true;
+            _g->lastopening -= rw_stopx - rw_x;
             ds_p->maskedtexturecol = maskedtexturecol = _g->lastopening - rw_x;
-            _g->lastopening += rw_stopx - rw_x;
         }
     }
 
@@ -2412,16 +2904,16 @@ static void R_StoreWallRange(const int start, const int stop)
     // save sprite clipping info
     if ((ds_p->silhouette & SIL_TOP || maskedtexture) && !ds_p->sprtopclip)
     {
+        _g->lastopening -= rw_stopx - start;
         ByteCopy((byte*)_g->lastopening, (const byte*)(ceilingclip+start), sizeof(short)*(rw_stopx-start));
         ds_p->sprtopclip = _g->lastopening - start;
-        _g->lastopening += rw_stopx - start;
     }
 
     if ((ds_p->silhouette & SIL_BOTTOM || maskedtexture) && !ds_p->sprbottomclip)
     {
+        _g->lastopening -= rw_stopx - start;
         ByteCopy((byte*)_g->lastopening, (const byte*)(floorclip+start), sizeof(short)*(rw_stopx-start));
         ds_p->sprbottomclip = _g->lastopening - start;
-        _g->lastopening += rw_stopx - start;
     }
 
     if (maskedtexture && !(ds_p->silhouette & SIL_TOP))
@@ -2770,8 +3262,34 @@ static boolean R_CheckBBox(const short *bspcoord)
 
 
 
+//
+// R_PVSVisible
+// False if nothing under this node or subsector can be seen
+// from the view sector. Always true without a PVS lump.
+//
+static boolean R_PVSVisible(int bspnum)
+{
+    int bit;
+
+    if (!_g->pvs)
+        return true;
+
+    if (bspnum == -1)
+        bit = numnodes;
+    else if (bspnum & NF_SUBSECTOR)
+        bit = numnodes + (bspnum & ~NF_SUBSECTOR);
+    else
+        bit = bspnum;
+
+    return (_g->pvsrow[bit >> 3] >> (bit & 7)) & 1;
+}
+
 static boolean R_RenderBspSubsector(int bspnum)
 {
+    // Hidden from here, nothing to do.
+    if (!R_PVSVisible(bspnum))
+        return true;
+
     // Found a subsector?
     if (bspnum & NF_SUBSECTOR)
     {
@@ -2835,7 +3353,7 @@ static void R_RenderBSPNode(int bspnum)
         // Possibly divide back space.
         //Walk back up the tree until we find
         //a node that has a visible backspace.
-        while(!R_CheckBBox (bsp->bbox[side^1]))
+        while(!R_PVSVisible(bsp->children[side^1]) || !R_CheckBBox (bsp->bbox[side^1]))
         {
             if(sp == 0)
             {
@@ -2879,21 +3397,79 @@ static void R_ClearSprites(void)
 // RDrawPlanes
 // At the end of each frame.
 //
+// Planes never share a pixel, so they can be drawn in any order.
+// Flats are sorted by lump and then colormap, which caches each flat
+// once and copies each colormap once per flat instead of per plane.
+// The list lives in the unused middle of the render arena; planes
+// that don't fit are drawn as they are found.
+//
+
+typedef struct
+{
+    visplane_t *pl;
+    int lump;
+    const lighttable_t *colormap;
+} planedraw_t;
 
 static void R_DrawPlanes (void)
 {
+    planedraw_t *list = (planedraw_t*)ds_p;
+    const int maxlist = ((byte*)_g->lastopening - (byte*)ds_p) / sizeof(planedraw_t);
+
+    int count = 0;
+
     for (int i=0; i<MAXVISPLANES; i++)
     {
         visplane_t *pl = _g->visplanes[i];
 
         while(pl)
         {
-            if(pl->modified)
-                R_DoDrawPlane(pl);
+            if(pl->modified && pl->minx <= pl->maxx)
+            {
+                if (pl->picnum == _g->skyflatnum)
+                    R_DrawSkyPlane(pl);
+                else
+                {
+                    const int lump = _g->flatlumps[flattranslation[pl->picnum]];
+
+                    if (count < maxlist)
+                    {
+                        // Insert after every entry that doesn't sort later.
+                        const lighttable_t *colormap = R_ColourMap(pl->lightlevel);
+
+                        int j = count++;
+
+                        for (; j > 0 && (list[j-1].lump > lump ||
+                                         (list[j-1].lump == lump && list[j-1].colormap > colormap)); j--)
+                            list[j] = list[j-1];
+
+                        list[j].pl = pl;
+                        list[j].lump = lump;
+                        list[j].colormap = colormap;
+                    }
+                    else
+                    {
+                        R_DrawFlatPlane(pl, W_CacheLumpNum(lump));
+                        W_UnlockLumpNum(lump);
+                    }
+                }
+            }
 
             pl = pl->next;
         }
     }
+
+    for (int i = 0; i < count; )
+    {
+        const int lump = list[i].lump;
+        const byte *source = W_CacheLumpNum(lump);
+
+        do
+            R_DrawFlatPlane(list[i++].pl, source);
+        while (i < count && list[i].lump == lump);
+
+        W_UnlockLumpNum(lump);
+    }
 }
 
 //
@@ -2911,21 +3487,81 @@ static void R_ClearPlanes(void)
 
 
     for (i=0;i<MAXVISPLANES;i++)    // new code -- killough
-        for (*_g->freehead = _g->visplanes[i], _g->visplanes[i] = NULL; *_g->freehead; )
-            _g->freehead = &(*_g->freehead)->next;
+    {
+        for (visplane_t *pl = _g->visplanes[i], *next; pl; pl = next)
+        {
+            const int wide = pl->width == SCREENWIDTH;
+
+            next = pl->next;
+            pl->next = _g->freeplanes[wide];
+            _g->freeplanes[wide] = pl;
+        }
+
+        _g->visplanes[i] = NULL;
+    }
+
+    _g->numvisplanes = 0;
 
-    _g->lastopening = _g->openings;
+    // The render arena, drawsegs already start at the other end.
+    _g->lastopening = (short*)(_g->drawsegs + MAXDRAWSEGS);
 
     basexscale = FixedMul(viewsin,iprojection);
     baseyscale = FixedMul(viewcos,iprojection);
 }
 
+//
+// R_SetupPVS
+// Unpacks the PVS row of the sector the view is in.
+// It only changes when the player crosses into another sector.
+//
+static void R_SetupPVS(void)
+{
+    const mappvs_t* pvs = _g->pvs;
+    const byte* in;
+    byte* out;
+    byte* end;
+    int sector;
+
+    if (!pvs)
+        return;
+
+    sector = R_PointInSubsector(viewx, viewy)->sector - _g->sectors;
+
+    if (sector == _g->pvssector)
+        return;
+
+    _g->pvssector = sector;
+
+    in = (const byte*)pvs + pvs->rowofs[sector];
+    out = _g->pvsrow;
+    end = out + pvs->rowbytes;
+
+    // Zero bytes come as a zero and a run length.
+    while (out < end)
+    {
+        if (*in)
+            *out++ = *in++;
+        else
+        {
+            int run = in[1];
+
+            if (run > end - out)
+                run = end - out;
+
+            memset(out, 0, run);
+            out += run;
+            in += 2;
+        }
+    }
+}
+
 //
 // R_RenderView
 //
 void R_RenderPlayerView (player_t* player)
 {
     R_SetupFrame (player);
+    R_SetupPVS ();
 
     // Clear buffers.
     R_ClearClipSegs ();
@@ -2933,12 +3569,35 @@ void R_RenderPlayerView (player_t* player)
     R_ClearPlanes ();
     R_ClearSprites ();
 
+    _g->colormapcopies = 0;
+
     // The head node is the last node output.
     R_RenderBSPNode (numnodes-1);
 
     R_DrawPlanes ();
 
     R_DrawMasked ();
+
+    // Render arena high water marks for R_PrintRenderStats.
+    const unsigned int used = (byte*)ds_p - (byte*)_g->drawsegs +
+            (byte*)(_g->drawsegs + MAXDRAWSEGS) - (byte*)_g->lastopening;
+
+    if ((unsigned int)(ds_p - _g->drawsegs) > _g->drawsegspeak)
+        _g->drawsegspeak = ds_p - _g->drawsegs;
+
+    if (num_vissprite > _g->visspritespeak)
+        _g->visspritespeak = num_vissprite;
+
+    if (used > _g->arenapeak)
+        _g->arenapeak = used;
+
+    if (_g->numvisplanes > _g->visplanespeak)
+        _g->visplanespeak = _g->numvisplanes;
+
+    if (_g->colormapcopies > _g->colormapcopiespeak)
+        _g->colormapcopiespeak = _g->colormapcopies;
+
+    _g->colormapcopiestotal += _g->colormapcopies;
 }
 
 void V_DrawPatchNoScale(int x, int y, const patch_t* patch)
@@ -3157,6 +3816,10 @@ boolean P_SetMobjState(mobj_t* mobj, statenum_t state)
 {
     const state_t*	st;
 
+    // Raised, crushed or otherwise disturbed.
+    if (mobj->flags & MF_DORMANT)
+        P_WakeThing(mobj);
+
     do
     {
         if (state == S_NULL)
@@ -3237,11 +3900,16 @@ void P_MobjThinker (mobj_t* mobj)
 
         // check for nightmare respawn
 
-        if (! (mobj->flags & MF_COUNTKILL) )
-            return;
+        if (! (mobj->flags & MF_COUNTKILL) || !_g->respawnmonsters)
+        {
+            // A corpse at rest has nothing left to do until
+            // something raises, crushes or moves it.
+            if ((mobj->flags & MF_CORPSE) && !(mobj->momx | mobj->momy | mobj->momz) &&
+                    mobj->z == mobj->floorz && !P_MobjIsPlayer(mobj))
+                P_SleepThing(mobj);
 
-        if (!_g->respawnmonsters)
             return;
+        }
 
         mobj->movecount++;
 
@@ -3290,12 +3958,25 @@ void P_RunThinkers (void)
 
     while(th != th_end)
     {
-        thinker_t* th_next = th->next;
-        if(th->function)
+        // P_WakeThing may move this back onto a woken mobj.
+        _g->nextthinker = th->next;
+
+        // Most of the list is mobjs, skip the indirect call for them.
+        if(th->function == P_MobjThinker)
+            P_MobjThinker((mobj_t*)th);
+        else if(th->function)
             th->function(th);
 
-        th = th_next;
+        th = _g->nextthinker;
     }
+
+    _g->nextthinker = NULL;
+
+    // The batched classes only change light levels and texture
+    // offsets, so running them after the list can't affect play.
+    T_StrobeFlashes(_g->thinkerbatches[tb_strobe].data, _g->thinkerbatches[tb_strobe].count);
+    T_Glows(_g->thinkerbatches[tb_glow].data, _g->thinkerbatches[tb_glow].count);
+    T_Scrollers(_g->thinkerbatches[tb_scroll].data, _g->thinkerbatches[tb_scroll].count);
 }
 
 
@@ -3346,4 +4027,22 @@ int I_GetTime(void)
     return thistimereply;
 }
 
+//
+// I_GetTimeMicros
+// Wraps every 71 minutes, only take differences.
+// The GBA has no timer to spare and always returns 0.
+//
+unsigned int I_GetTimeMicros(void)
+{
+#ifdef RP2040
+    return time_us_32();
+#else
+#ifndef GBA
+    return (unsigned int)(((unsigned long long)clock() * 1000000) / CLOCKS_PER_SEC);
+#else
+    return 0;
+#endif
+#endif
+}
+
 
@@ -107,3 +107,31 @@ void R_SetupFrame (player_t *player)
 }
 
 
+
+//
+// R_PrintRenderStats
+// Reports how much of the render arena the frames since the last
+// report needed, and what had to be dropped for want of room.
+//
+
+void R_PrintRenderStats(void)
+{
+    if (_g->arenapeak)
+        lprintf(LO_INFO, "R_RenderPlayerView: %u of %u arena bytes peak, %u drawsegs, %u vissprites",
+                _g->arenapeak, (unsigned int)(MAXDRAWSEGS * sizeof(drawseg_t)), _g->drawsegspeak, _g->visspritespeak);
+
+    if (_g->visplanespeak)
+        lprintf(LO_INFO, "R_RenderPlayerView: %u visplanes peak", _g->visplanespeak);
+
+    if (_g->colormapcopiestotal)
+        lprintf(LO_INFO, "R_RenderPlayerView: %u colormap copies, %u in the worst frame",
+                _g->colormapcopiestotal, _g->colormapcopiespeak);
+
+    if (_g->drawsegoverflows || _g->openingoverflows || _g->visspriteoverflows)
+        lprintf(LO_INFO, "R_RenderPlayerView: dropped %u drawsegs, %u openings, %u vissprites",
+                _g->drawsegoverflows, _g->openingoverflows, _g->visspriteoverflows);
+
+    _g->arenapeak = _g->drawsegspeak = _g->visspritespeak = _g->visplanespeak = 0;
+    _g->colormapcopiespeak = _g->colormapcopiestotal = 0;
+    _g->drawsegoverflows = _g->openingoverflows = _g->visspriteoverflows = 0;
+}
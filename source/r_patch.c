@@ -47,14 +47,20 @@
 int R_NumPatchWidth(int lump)
 {
     const patch_t* patch = W_CacheLumpNum(lump);
+    const int width = patch->width;
 
-    return patch->width;
+    W_UnlockLumpNum(lump);
+
+    return width;
 }
 
 //---------------------------------------------------------------------------
 int R_NumPatchHeight(int lump)
 {
     const patch_t* patch = W_CacheLumpNum(lump);
+    const int height = patch->height;
+
+    W_UnlockLumpNum(lump);
 
-    return patch->height;
+    return height;
 }
@@ -82,6 +82,5 @@ void R_InitPlanes (void)
 void R_ResetPlanes()
 {
     memset(_g->visplanes, 0, sizeof(_g->visplanes));
-    _g->freetail = NULL;
-    _g->freehead = &_g->freetail;
+    memset(_g->freeplanes, 0, sizeof(_g->freeplanes));
 }
@@ -83,7 +83,7 @@ static void R_InstallSpriteLump(int lump, unsigned frame,
       {
           if (_g->sprtemp[frame].lump[r]==-1)
           {
-              _g->sprtemp[frame].lump[r] = lump - _g->firstspritelump;
+              _g->sprtemp[frame].lump[r] = lump;
 
               if(flipped)
                 _g->sprtemp[frame].flipmask |= (1 << r);
@@ -98,7 +98,7 @@ static void R_InstallSpriteLump(int lump, unsigned frame,
 
   if (_g->sprtemp[frame].lump[--rotation] == -1)
   {
-      _g->sprtemp[frame].lump[rotation] = lump - _g->firstspritelump;
+      _g->sprtemp[frame].lump[rotation] = lump;
 
       if(flipped)
         _g->sprtemp[frame].flipmask |= (1 << rotation);
@@ -137,7 +137,7 @@ static void R_InstallSpriteLump(int lump, unsigned frame,
 
 static void R_InitSpriteDefs(const char * const * namelist)
 {
-  size_t numentries = _g->lastspritelump-_g->firstspritelump+1;
+  size_t numentries = _g->numspritelumps;
   struct { int index, next; } *hash;
   int i;
 
@@ -164,7 +164,7 @@ static void R_InitSpriteDefs(const char * const * namelist)
 
   for (i=0; (size_t)i<numentries; i++)             // Prepend each sprite to hash chain
     {                                      // prepend so that later ones win
-      const char* sn = W_GetNameForNum(i+_g->firstspritelump);
+      const char* sn = W_GetNameForNum(_g->spritelumps[i]);
 
       int j = R_SpriteNameHash(sn) % numentries;
       hash[i].next = hash[j].index;
@@ -185,7 +185,7 @@ static void R_InitSpriteDefs(const char * const * namelist)
           _g->maxframe = -1;
           do
             {
-              const char* sn = W_GetNameForNum(j + _g->firstspritelump);
+              const char* sn = W_GetNameForNum(_g->spritelumps[j]);
 
               // Fast portable comparison -- killough
               // (using int pointer cast is nonportable):
@@ -195,12 +195,12 @@ static void R_InitSpriteDefs(const char * const * namelist)
                     (sn[2] ^ spritename[2]) |
                     (sn[3] ^ spritename[3])))
                 {
-                  R_InstallSpriteLump(j+_g->firstspritelump,
+                  R_InstallSpriteLump(j,
                                       sn[4] - 'A',
                                       sn[5] - '0',
                                       false);
                   if (sn[6])
-                    R_InstallSpriteLump(j+_g->firstspritelump,
+                    R_InstallSpriteLump(j,
                                         sn[6] - 'A',
                                         sn[7] - '0',
                                         true);
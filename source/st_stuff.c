@@ -483,21 +483,21 @@ static void ST_loadGraphics(boolean doload)
     {
         //sprintf(namebuf, "STTNUM%d", i);
 		sprintf(namebuf, "STGANUM%d", i); //Special GBA Doom II Red Numbers ~Kippykip
-        _g->tallnum[i] = (const patch_t *) W_CacheLumpName(namebuf);
+        _g->tallnum[i] = (const patch_t *) W_CacheLumpNamePinned(namebuf);
 
         sprintf(namebuf, "STYSNUM%d", i);
-        _g->shortnum[i] = (const patch_t *) W_CacheLumpName(namebuf);
+        _g->shortnum[i] = (const patch_t *) W_CacheLumpNamePinned(namebuf);
     }
 
     // Load percent key.
     //Note: why not load STMINUS here, too?
-    _g->tallpercent = (const patch_t*) W_CacheLumpName("STTPRCNT");
+    _g->tallpercent = (const patch_t*) W_CacheLumpNamePinned("STTPRCNT");
 
     // key cards
     for (i=0;i<NUMCARDS;i++)
     {
         sprintf(namebuf, "STKEYS%d", i);
-        _g->keys[i] = (const patch_t *) W_CacheLumpName(namebuf);
+        _g->keys[i] = (const patch_t *) W_CacheLumpNamePinned(namebuf);
     }
 
     // arms ownership widgets
@@ -506,7 +506,7 @@ static void ST_loadGraphics(boolean doload)
         sprintf(namebuf, "STGNUM%d", i+2);
 
         // gray #
-        _g->arms[i][0] = (const patch_t *) W_CacheLumpName(namebuf);
+        _g->arms[i][0] = (const patch_t *) W_CacheLumpNamePinned(namebuf);
 
         // yellow #
         _g->arms[i][1] = (const patch_t *) _g->shortnum[i+2];
@@ -524,21 +524,21 @@ static void ST_loadGraphics(boolean doload)
         for (int j=0;j<ST_NUMSTRAIGHTFACES;j++)
         {
             sprintf(namebuf, "STFST%d%d", i, j);
-            _g->faces[facenum++] = W_CacheLumpName(namebuf);
+            _g->faces[facenum++] = W_CacheLumpNamePinned(namebuf);
         }
         sprintf(namebuf, "STFTR%d0", i);	// turn right
-        _g->faces[facenum++] = W_CacheLumpName(namebuf);
+        _g->faces[facenum++] = W_CacheLumpNamePinned(namebuf);
         sprintf(namebuf, "STFTL%d0", i);	// turn left
-        _g->faces[facenum++] = W_CacheLumpName(namebuf);
+        _g->faces[facenum++] = W_CacheLumpNamePinned(namebuf);
         sprintf(namebuf, "STFOUCH%d", i);	// ouch!
-        _g->faces[facenum++] = W_CacheLumpName(namebuf);
+        _g->faces[facenum++] = W_CacheLumpNamePinned(namebuf);
         sprintf(namebuf, "STFEVL%d", i);	// evil grin ;)
-        _g->faces[facenum++] = W_CacheLumpName(namebuf);
+        _g->faces[facenum++] = W_CacheLumpNamePinned(namebuf);
         sprintf(namebuf, "STFKILL%d", i);	// pissed off
-        _g->faces[facenum++] = W_CacheLumpName(namebuf);
+        _g->faces[facenum++] = W_CacheLumpNamePinned(namebuf);
     }
-    _g->faces[facenum++] = W_CacheLumpName("STFGOD0");
-    _g->faces[facenum++] = W_CacheLumpName("STFDEAD0");
+    _g->faces[facenum++] = W_CacheLumpNamePinned("STFGOD0");
+    _g->faces[facenum++] = W_CacheLumpNamePinned("STFDEAD0");
 }
 
 static void ST_loadData(void)
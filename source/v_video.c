@@ -62,7 +62,7 @@ void V_DrawBackground(const char* flatname)
     unsigned short *dest = _g->screens[0].data;
 
     // killough 4/17/98:
-    src = W_CacheLumpNum(lump = _g->firstflat + R_FlatNumForName(flatname));
+    src = W_CacheLumpNum(lump = _g->flatlumps[R_FlatNumForName(flatname)]);
 
     for(unsigned int y = 0; y < SCREENHEIGHT; y++)
     {
@@ -79,6 +79,8 @@ void V_DrawBackground(const char* flatname)
             BlockCopy(d, s, len);
         }
     }
+
+    W_UnlockLumpNum(lump);
 }
 
 
@@ -185,6 +187,7 @@ void V_DrawNumPatch(int x, int y, int scrn, int lump,
          int cm, enum patch_translation_e flags)
 {
     V_DrawPatch(x, y, scrn, W_CacheLumpNum(lump));
+    W_UnlockLumpNum(lump);
 }
 
 //
@@ -213,7 +216,7 @@ void V_SetPalLump(int index)
     else
         lumpName[7] = '0' + index;
 
-    _g->pallete_lump = W_CacheLumpName(lumpName);
+    _g->pallete_lump = W_CacheLumpNamePinned(lumpName);
 }
 
 //
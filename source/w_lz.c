@@ -0,0 +1,87 @@
+#include "w_lz.h"
+
+//
+// W_LZDecompress
+// Decodes a raw LZ4 block (no frame header).
+//
+// Each sequence is a token byte, literal length extension,
+// literals, a 16 bit match offset and match length extension.
+// The last sequence carries literals only.
+//
+int W_LZDecompress(const byte* src, int srclen, byte* dest, int destlen)
+{
+    const byte* ip = src;
+    const byte* const iend = src + srclen;
+
+    byte* op = dest;
+    byte* const oend = dest + destlen;
+
+    while(ip < iend)
+    {
+        const unsigned int token = *ip++;
+
+        unsigned int len = token >> 4;
+
+        if(len == 15)
+        {
+            unsigned int s;
+
+            do
+            {
+                if(ip >= iend)
+                    return -1;
+
+                s = *ip++;
+                len += s;
+            } while(s == 255);
+        }
+
+        if(len > (unsigned int)(iend - ip) || len > (unsigned int)(oend - op))
+            return -1;
+
+        while(len--)
+            *op++ = *ip++;
+
+        //Last sequence has no match part.
+        if(ip >= iend)
+            break;
+
+        if(iend - ip < 2)
+            return -1;
+
+        const unsigned int offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+
+        if(offset == 0 || offset > (unsigned int)(op - dest))
+            return -1;
+
+        len = token & 15;
+
+        if(len == 15)
+        {
+            unsigned int s;
+
+            do
+            {
+                if(ip >= iend)
+                    return -1;
+
+                s = *ip++;
+                len += s;
+            } while(s == 255);
+        }
+
+        len += 4;
+
+        if(len > (unsigned int)(oend - op))
+            return -1;
+
+        //Matches may overlap the output so copy bytewise.
+        const byte* match = op - offset;
+
+        while(len--)
+            *op++ = *match++;
+    }
+
+    return op - dest;
+}
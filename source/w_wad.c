@@ -41,6 +41,8 @@
 #endif
 
 #include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
 
 #include "doomstat.h"
 #include "d_net.h"
@@ -53,6 +55,8 @@
 #pragma implementation "w_wad.h"
 #endif
 #include "w_wad.h"
+#include "w_lz.h"
+#include "z_zone.h"
 #include "lprintf.h"
 
 #include "global_data.h"
@@ -91,6 +95,19 @@ void ExtractFileBase (const char *path, char *dest)
 // LUMP BASED ROUTINES.
 //
 
+//
+// W_ReadBytes
+// Reads from the block device, bombs out on short reads.
+//
+
+static void W_ReadBytes(unsigned int offset, void* dest, int len)
+{
+    if(_g->wadread(offset, dest, len) != len)
+        I_Error("W_ReadBytes: Read error at %u", offset);
+
+    _g->lumpcachereadbytes += len;
+}
+
 //
 // W_AddFile
 // All files are optional, but at least one file must be
@@ -104,80 +121,234 @@ void ExtractFileBase (const char *path, char *dest)
 // CPhipps - source is an enum
 //
 // proff - changed using pointer to wadfile_info_t
-static void W_AddFile()
+//
+// data is the wad if it can be read in place, otherwise
+// it is read from the block device at base.
+//
+static void W_AddFile(const wadinfo_t* header, const byte* data, unsigned int base)
 {
-    const wadinfo_t* header;
+    if(_g->numwadfiles == MAXWADFILES)
+    {
+        lprintf(LO_WARN, "W_AddFile: Too many wads, %.4s ignored", header->identification);
+        return;
+    }
+
+    if(_g->numwadfiles == 0 && strncmp(header->identification,"IWAD",4))
+        I_Error("W_AddFile: Wad file doesn't have IWAD id");
 
-    if(doom_iwad_len > 0)
+    wadfile_t* wad = &_g->wadfiles[_g->numwadfiles++];
+
+    wad->data = data;
+    wad->base = base;
+    wad->firstlump = _g->numlumps;
+    wad->numlumps = header->numlumps;
+
+    if(data)
+    {
+        wad->lumpinfo = (const filelump_t*)&data[header->infotableofs];
+    }
+    else
     {
-        header = (wadinfo_t*)&doom_iwad[0];
+        filelump_t* fileinfo = Z_Malloc(header->numlumps * sizeof(filelump_t), PU_STATIC, NULL);
 
-        if (strncmp(header->identification,"IWAD",4))
-            I_Error("W_AddFile: Wad file doesn't have IWAD id");
+        W_ReadBytes(base + header->infotableofs, fileinfo, header->numlumps * sizeof(filelump_t));
+
+        wad->lumpinfo = fileinfo;
     }
+
+    _g->numlumps += header->numlumps;
+
+    lprintf(LO_INFO, "W_AddFile: %.4s with %d lumps", header->identification, header->numlumps);
 }
 
-//Return -1 if not found.
-//Set lump ptr if found.
+//
+// W_DeviceFileEnd
+// The directory doesn't have to come last, so a wad ends where
+// the directory or its furthest lump does. Lumps don't overlap,
+// so only the compressed lump stored last needs its length read.
+//
+static unsigned int W_DeviceFileEnd(const wadfile_t* wad, const wadinfo_t* header)
+{
+    unsigned int end = header->infotableofs + header->numlumps * sizeof(filelump_t);
+    unsigned int lastlz = 0;
+    boolean haslz = false;
 
-static int PUREFUNC FindLumpByName(const char* name, const filelump_t** lump)
+    for(int i = 0; i < wad->numlumps; i++)
+    {
+        const filelump_t* l = &wad->lumpinfo[i];
+        const unsigned int filepos = (unsigned int)l->filepos & ~LUMP_COMPRESSED;
+
+        if((unsigned int)l->filepos & LUMP_COMPRESSED)
+        {
+            if(!haslz || filepos > lastlz)
+                lastlz = filepos;
+
+            haslz = true;
+        }
+        else if(l->size && filepos + l->size > end)
+        {
+            end = filepos + l->size;
+        }
+    }
+
+    if(haslz)
+    {
+        int csize;
+
+        W_ReadBytes(wad->base + lastlz, &csize, sizeof(csize));
+
+        if(lastlz + sizeof(lzlump_t) + csize > end)
+            end = lastlz + sizeof(lzlump_t) + csize;
+    }
+
+    return end;
+}
+
+//
+// W_AddDeviceFiles
+// Wads on the block device are stored back to back, each one
+// starting on the first 512 byte boundary after the end of the
+// one before. An IWAD there replaces the built in one.
+//
+static void W_AddDeviceFiles(void)
 {
-    const wadinfo_t* header;
-    const filelump_t  *fileinfo;
+    unsigned int offset = 0;
+    wadinfo_t header;
 
-    if(doom_iwad_len > 0)
+    while(_g->wadread(offset, &header, sizeof(header)) == sizeof(header))
     {
-        header = (const wadinfo_t*)&doom_iwad[0];
+        const boolean iwad = !strncmp(header.identification,"IWAD",4);
 
-        fileinfo = (filelump_t*)&doom_iwad[header->infotableofs];
+        if(!iwad && strncmp(header.identification,"PWAD",4))
+            break;
 
-        int_64_t nameint = 0;
-        strncpy((char*)&nameint, name, 8);
+        if(iwad && offset)
+            break;
 
-        for(int i = header->numlumps - 1; i >= 0; i--)
-        {
-            //This is a bit naughty with alignment.
-            //For x86 doesn't matter because unaligned loads
-            //are fine.
-            //On ARM, unaligned loads are not fine but since it
-            //doesn't have a 64bit load, the compiler will generate
-            //32 bit loads. These vars are 32 aligned.
+        if(!iwad && !_g->numwadfiles && doom_iwad_len > 0)
+            W_AddFile((const wadinfo_t*)doom_iwad, doom_iwad, 0);
 
-            int_64_t nameint2 = *(int_64_t*)fileinfo[i].name;
+        W_AddFile(&header, NULL, offset);
 
-            if(nameint == nameint2)
-            {
-                *lump = &fileinfo[i];
-                return i;
-            }
-        }
+        const wadfile_t* wad = &_g->wadfiles[_g->numwadfiles - 1];
+
+        //Dropped by W_AddFile, there is no room for more.
+        if(wad->data || wad->base != offset)
+            break;
+
+        offset += W_DeviceFileEnd(wad, &header);
+        offset = (offset + 511) & ~511;
     }
+}
 
-    *lump = NULL;
-    return -1;
+//
+// W_LumpNameHash
+// Only the top lumphashbits bits are used.
+//
+static unsigned int W_LumpNameHash(int_64_t nameint)
+{
+    const unsigned int lo = (unsigned int)nameint;
+    const unsigned int hi = (unsigned int)(nameint >> 32);
+
+    return (lo ^ (hi * 31)) * 2654435761u;
 }
 
-static const filelump_t* PUREFUNC FindLumpByNum(int num)
+static int_64_t W_LumpNameInt(const char* name)
 {
-    const wadinfo_t* header;
-    const filelump_t  *fileinfo;
+    int_64_t nameint = 0;
+    strncpy((char*)&nameint, name, 8);
+
+    return nameint;
+}
 
-    if(num < 0)
+//
+// W_FileForLump
+// There are only ever a few wads so a linear search is fine.
+//
+static const wadfile_t* PUREFUNC W_FileForLump(int lump)
+{
+    const wadfile_t* wad = &_g->wadfiles[_g->numwadfiles - 1];
+
+    while(lump < wad->firstlump)
+        wad--;
+
+    return wad;
+}
+
+static const filelump_t* PUREFUNC FindLumpByNum(int num)
+{
+    if(num < 0 || num >= _g->numlumps)
         return NULL;
 
-    if(doom_iwad_len > 0)
+    const wadfile_t* wad = W_FileForLump(num);
+
+    return &wad->lumpinfo[num - wad->firstlump];
+}
+
+//
+// W_InitHash
+// Chains the lumps of all wads by name. Later lumps are put
+// in front, so a PWAD lump overrides the IWAD lump it shares
+// a name with.
+//
+static void W_InitHash(void)
+{
+    if(_g->numlumps > SHRT_MAX)
+        I_Error("W_InitHash: Too many lumps (%d)", _g->numlumps);
+
+    int bits = 1;
+
+    while((1 << bits) < _g->numlumps)
+        bits++;
+
+    _g->lumphashbits = bits;
+    _g->lumphash = Z_Malloc((1 << bits) * sizeof(short), PU_STATIC, NULL);
+    _g->lumpnext = Z_Malloc(_g->numlumps * sizeof(short), PU_STATIC, NULL);
+
+    for(int i = 0; i < (1 << bits); i++)
+        _g->lumphash[i] = -1;
+
+    for(int i = 0; i < _g->numlumps; i++)
     {
-        header = (const wadinfo_t*)&doom_iwad[0];
+        //This is a bit naughty with alignment.
+        //For x86 doesn't matter because unaligned loads
+        //are fine.
+        //On ARM, unaligned loads are not fine but since it
+        //doesn't have a 64bit load, the compiler will generate
+        //32 bit loads. These vars are 32 aligned.
+
+        const unsigned int h = W_LumpNameHash(*(const int_64_t*)FindLumpByNum(i)->name) >> (32 - bits);
 
-        if(num >= header->numlumps)
-            return NULL;
+        _g->lumpnext[i] = _g->lumphash[h];
+        _g->lumphash[h] = i;
+    }
+}
 
-        fileinfo = (const filelump_t*)&doom_iwad[header->infotableofs];
+//Return -1 if not found.
+//Set lump ptr if found.
 
-        return &fileinfo[num];
+static int PUREFUNC FindLumpByName(const char* name, const filelump_t** lump)
+{
+    if(_g->numlumps)
+    {
+        const int_64_t nameint = W_LumpNameInt(name);
+
+        int i = _g->lumphash[W_LumpNameHash(nameint) >> (32 - _g->lumphashbits)];
+
+        for(; i != -1; i = _g->lumpnext[i])
+        {
+            const filelump_t* l = FindLumpByNum(i);
+
+            if(nameint == *(const int_64_t*)l->name)
+            {
+                *lump = l;
+                return i;
+            }
+        }
     }
 
-    return NULL;
+    *lump = NULL;
+    return -1;
 }
 
 //
@@ -248,11 +419,100 @@ const char* PUREFUNC W_GetNameForNum(int lump)
 // CPhipps - modified to use the new wadfiles array
 //
 
+//
+// W_InitCache
+// Lumps on a block device and compressed lumps need a lump
+// cache. Everything else is read in place.
+//
+
+static void W_InitCache(void)
+{
+    int numcompressed = 0;
+
+    for(int i = 0; i < _g->numlumps; i++)
+    {
+        if((unsigned int)FindLumpByNum(i)->filepos & LUMP_COMPRESSED)
+            numcompressed++;
+    }
+
+    boolean ondevice = false;
+
+    for(int i = 0; i < _g->numwadfiles; i++)
+        ondevice |= !_g->wadfiles[i].data;
+
+    if(!numcompressed && !ondevice)
+        return;
+
+    lprintf(LO_INFO, "W_InitCache: %d compressed lumps.", numcompressed);
+
+    _g->lumpcache = Z_Calloc(_g->numlumps, sizeof(lumpcache_t), PU_STATIC, NULL);
+
+    for(int i = 0; i < _g->numlumps; i++)
+        _g->lumpcache[i].lruprev = _g->lumpcache[i].lrunext = -1;
+
+    _g->lruhead = _g->lrutail = -1;
+}
+
+//
+// W_SetBlockDevice
+// Reads the wad through read instead of from doom_iwad.
+// Must be called before W_Init.
+//
+
+void W_SetBlockDevice(w_readfunc_t read)
+{
+    _g->wadread = read;
+}
+
 void W_Init(void)
 {
     // CPhipps - start with nothing
 
-    W_AddFile();
+    if(_g->wadread)
+        W_AddDeviceFiles();
+
+    if(!_g->numwadfiles && doom_iwad_len > 0)
+        W_AddFile((const wadinfo_t*)doom_iwad, doom_iwad, 0);
+
+    if(!_g->numwadfiles)
+        I_Error("W_Init: No wad found");
+
+    W_InitHash();
+
+    W_InitCache();
+}
+
+//
+// W_GetNamespace
+// Finds the lumps between x_START and x_END, or the xx_START
+// and xx_END markers PWADs use, in one wad. Returns false if
+// the wad doesn't have them.
+//
+
+boolean W_GetNamespace(int file, char ns, int* first, int* last)
+{
+    const wadfile_t* wad = &_g->wadfiles[file];
+
+    char start[2][9], end[2][9];
+
+    snprintf(start[0], sizeof(start[0]), "%c_START", ns);
+    snprintf(start[1], sizeof(start[1]), "%c%c_START", ns, ns);
+    snprintf(end[0], sizeof(end[0]), "%c_END", ns);
+    snprintf(end[1], sizeof(end[1]), "%c%c_END", ns, ns);
+
+    *first = *last = -1;
+
+    for(int i = 0; i < wad->numlumps; i++)
+    {
+        const char* name = wad->lumpinfo[i].name;
+
+        if(*first == -1 && (!strncmp(name, start[0], 8) || !strncmp(name, start[1], 8)))
+            *first = wad->firstlump + i + 1;
+        else if(*first != -1 && (!strncmp(name, end[0], 8) || !strncmp(name, end[1], 8)))
+            *last = wad->firstlump + i - 1;
+    }
+
+    return *first != -1 && *last != -1;
 }
 
 //
@@ -274,19 +534,250 @@ int PUREFUNC W_LumpLength(int lump)
     return 0;
 }
 
-static const void* PUREFUNC W_GetLumpPtr(int lump)
+//
+// LRU list of unlocked cached lumps.
+//
+
+static boolean W_LRUContains(int lump)
+{
+    return _g->lumpcache[lump].lruprev != -1 || _g->lruhead == lump;
+}
+
+static void W_LRURemove(int lump)
 {
-    const filelump_t* l = FindLumpByNum(lump);
+    lumpcache_t* lc = &_g->lumpcache[lump];
 
-    if(l)
+    if(lc->lruprev != -1)
+        _g->lumpcache[lc->lruprev].lrunext = lc->lrunext;
+    else
+        _g->lruhead = lc->lrunext;
+
+    if(lc->lrunext != -1)
+        _g->lumpcache[lc->lrunext].lruprev = lc->lruprev;
+    else
+        _g->lrutail = lc->lruprev;
+
+    lc->lruprev = lc->lrunext = -1;
+}
+
+static void W_LRUAddHead(int lump)
+{
+    lumpcache_t* lc = &_g->lumpcache[lump];
+
+    lc->lruprev = -1;
+    lc->lrunext = _g->lruhead;
+
+    if(_g->lruhead != -1)
+        _g->lumpcache[_g->lruhead].lruprev = lump;
+    else
+        _g->lrutail = lump;
+
+    _g->lruhead = lump;
+}
+
+//
+// W_EvictLumps
+// Frees the least recently used lumps until size more bytes fit.
+// The zone may already have purged some of them.
+//
+
+static void W_EvictLumps(unsigned int size)
+{
+    while(_g->lrutail != -1 && _g->lumpcachebytes + size > LUMPCACHESIZE)
     {
-        return (const void*)&doom_iwad[l->filepos];
+        const int lump = _g->lrutail;
+        lumpcache_t* lc = &_g->lumpcache[lump];
+
+        W_LRURemove(lump);
+
+        if(lc->cache)
+        {
+            Z_Free(lc->cache);
+            _g->lumpcacheevictions++;
+        }
+
+        _g->lumpcachebytes -= FindLumpByNum(lump)->size;
     }
+}
 
-    return NULL;
+//
+// W_ReadLump
+// Fills dest with the lump, decompressing it if needed.
+//
+
+static void W_ReadLump(const wadfile_t* wad, const filelump_t* l, void* dest)
+{
+    const unsigned int filepos = (unsigned int)l->filepos & ~LUMP_COMPRESSED;
+
+    if(!((unsigned int)l->filepos & LUMP_COMPRESSED))
+    {
+        W_ReadBytes(wad->base + filepos, dest, l->size);
+        return;
+    }
+
+    const lzlump_t* lz;
+
+    if(!wad->data)
+    {
+        int csize;
+
+        W_ReadBytes(wad->base + filepos, &csize, sizeof(csize));
+
+        lzlump_t* buf = Z_Malloc(sizeof(lzlump_t) + csize, PU_STATIC, NULL);
+
+        W_ReadBytes(wad->base + filepos, buf, sizeof(lzlump_t) + csize);
+
+        lz = buf;
+    }
+    else
+    {
+        lz = (const lzlump_t*)&wad->data[filepos];
+    }
+
+    if(W_LZDecompress(lz->data, lz->csize, dest, l->size) != l->size)
+        I_Error("W_ReadLump: %.8s is corrupt", l->name);
+
+    if(!wad->data)
+        Z_Free((void*)lz);
 }
 
-const void* PUREFUNC W_CacheLumpNum(int lump)
+//
+// W_CacheZoneLump
+// Loads a lump into the zone, or reuses the copy from
+// last time if it hasn't been evicted yet.
+//
+
+static const void* W_CacheZoneLump(int lump, const filelump_t* l)
+{
+    lumpcache_t* lc = &_g->lumpcache[lump];
+
+    if(lc->cache)
+    {
+        _g->lumpcachehits++;
+
+        if(!lc->locks)
+        {
+            W_LRURemove(lump);
+            Z_ChangeTag(lc->cache, PU_STATIC);
+        }
+    }
+    else
+    {
+        _g->lumpcachemisses++;
+
+        //Purged by the zone while unlocked.
+        if(W_LRUContains(lump))
+        {
+            W_LRURemove(lump);
+            _g->lumpcachebytes -= l->size;
+        }
+
+        W_EvictLumps(l->size);
+
+        Z_Malloc(l->size, PU_STATIC, &lc->cache);
+
+        W_ReadLump(W_FileForLump(lump), l, lc->cache);
+
+        _g->lumpcachebytes += l->size;
+    }
+
+    //A lock count this high means a missing W_UnlockLumpNum.
+    if(lc->locks != LUMPPINNED && ++lc->locks == LUMPPINNED)
+        I_Error("W_CacheLumpNum: %.8s is never unlocked", l->name);
+
+    return lc->cache;
+}
+
+//
+// W_CacheLumpNum
+// Lumps are read in place from the wad, unless they are
+// compressed or on a block device. Those are locked in
+// memory until the matching W_UnlockLumpNum.
+//
+
+const void* W_CacheLumpNum(int lump)
+{
+    if(lump < 0 || lump >= _g->numlumps)
+        return NULL;
+
+    const wadfile_t* wad = W_FileForLump(lump);
+    const filelump_t* l = &wad->lumpinfo[lump - wad->firstlump];
+
+    if(!wad->data || ((unsigned int)l->filepos & LUMP_COMPRESSED))
+        return W_CacheZoneLump(lump, l);
+
+    return (const void*)&wad->data[l->filepos];
+}
+
+//
+// W_CacheLumpNumPinned
+// As W_CacheLumpNum, but the lump is never evicted and
+// needs no W_UnlockLumpNum.
+//
+
+const void* W_CacheLumpNumPinned(int lump)
+{
+    const void* data = W_CacheLumpNum(lump);
+
+    //Only zone copies are locked.
+    if(data && _g->lumpcache && _g->lumpcache[lump].locks)
+        _g->lumpcache[lump].locks = LUMPPINNED;
+
+    return data;
+}
+
+//
+// W_UnlockLumpNum
+// Lets the cache evict a lump once nobody holds a
+// pointer into it. Does nothing for lumps read in place.
+//
+
+void W_UnlockLumpNum(int lump)
 {
-    return W_GetLumpPtr(lump);
+    if(!_g->lumpcache || lump < 0)
+        return;
+
+    lumpcache_t* lc = &_g->lumpcache[lump];
+
+    if(lc->locks && lc->locks != LUMPPINNED && !--lc->locks)
+    {
+        Z_ChangeTag(lc->cache, PU_CACHE);
+        W_LRUAddHead(lump);
+    }
+}
+
+//
+// W_ReadAheadLumps
+// Reads a run of lumps in file order so the device sees one
+// sequential read, as long as they fit in the cache without
+// evicting each other.
+//
+
+void W_ReadAheadLumps(int lump, int count)
+{
+    //Nothing to gain for wads read in place.
+    if(!_g->lumpcache || lump < 0 || lump >= _g->numlumps || W_FileForLump(lump)->data)
+        return;
+
+    for(int i = lump; i < lump + count && i < _g->numlumps; i++)
+    {
+        if(_g->lumpcache[i].cache)
+            continue;
+
+        if(_g->lumpcachebytes + FindLumpByNum(i)->size > LUMPCACHESIZE)
+            break;
+
+        W_CacheLumpNum(i);
+        W_UnlockLumpNum(i);
+    }
+}
+
+void W_PrintCacheStats(void)
+{
+    if(!_g->lumpcache)
+        return;
+
+    lprintf(LO_INFO, "W_LumpCache: %u hits, %u misses, %u evictions, %uK read, %uK cached",
+            _g->lumpcachehits, _g->lumpcachemisses, _g->lumpcacheevictions,
+            _g->lumpcachereadbytes >> 10, _g->lumpcachebytes >> 10);
 }
@@ -382,6 +382,8 @@ WI_drawOnLnode  // draw stuff at a location by episode/map#
     right = left + patch->width;
     bottom = top + patch->height;
 
+    W_UnlockLumpName(c[i]);
+
     if (left >= 0
        && right < 320
        && top >= 0
@@ -1019,7 +1021,7 @@ void WI_loadData(void)
     // numbers 0-9
     sprintf(name, "WINUM%d", i);
 
-    _g->num[i] = W_CacheLumpName(name);
+    _g->num[i] = W_CacheLumpNamePinned(name);
   }
 }
 
@@ -43,73 +43,91 @@
 typedef struct bmalpool_s {
   struct bmalpool_s *nextpool;
   size_t             blocks;
-  byte               used[0];
 } bmalpool_t;
 
+// Free elements are chained through their own first word.
+typedef struct bmalfree_s {
+  struct bmalfree_s *next;
+} bmalfree_t;
+
 __inline static void* getelem(bmalpool_t *p, size_t size, size_t n)
 {
-  return (((byte*)p) + sizeof(bmalpool_t) + sizeof(byte)*(p->blocks) + size*n);
+  return (((byte*)p) + sizeof(bmalpool_t) + size*n);
 }
 
+#ifdef RANGECHECK
 __inline static PUREFUNC int iselem(const bmalpool_t *pool, size_t size, const void* p)
 {
   // CPhipps - need portable # of bytes between pointers
   int dif = (const char*)p - (const char*)pool;
 
   dif -= sizeof(bmalpool_t);
-  dif -= pool->blocks;
   if (dif<0) return -1;
   dif /= size;
   return (((size_t)dif >= pool->blocks) ? -1 : dif);
 }
+#endif
 
-enum { unused_block = 0, used_block = 1};
-
+//
+// Z_BMalloc
+// Pops the free list. When it runs dry a whole new pool is
+// threaded onto it. Pools are only given back to the zone
+// along with everything else of their tag, so an element
+// never has to be traced back to its pool.
+//
 void* Z_BMalloc(struct block_memory_alloc_s *pzone)
 {
-  register bmalpool_t **pool = (bmalpool_t **)&(pzone->firstpool);
-  while (*pool != NULL) {
-    byte *p = memchr((*pool)->used, unused_block, (*pool)->blocks); // Scan for unused marker
-    if (p) {
-      int n = p - (*pool)->used;
-      (*pool)->used[n] = used_block;
-      return getelem(*pool, pzone->size, n);
-    } else
-      pool = &((*pool)->nextpool);
-  }
-  {
-    // Nothing available, must allocate a new pool
-    bmalpool_t *newpool;
+  bmalfree_t *p = pzone->freelist;
 
-    // CPhipps: Allocate new memory, initialised to 0
-
-    *pool = newpool = Z_Calloc(sizeof(*newpool) + (sizeof(byte) + pzone->size)*(pzone->perpool),
-             1,  pzone->tag, NULL);
-    newpool->nextpool = NULL; // NULL = (void*)0 so this is redundant
+  if (!p) {
+    // Nothing available, must allocate a new pool
+    bmalpool_t *newpool = Z_Malloc(sizeof(*newpool) + pzone->size*pzone->perpool, pzone->tag, NULL);
+    size_t n = pzone->perpool;
 
-    // Return element 0 from this pool to satisfy the request
-    newpool->used[0] = used_block;
+    newpool->nextpool = pzone->firstpool;
     newpool->blocks = pzone->perpool;
-    return getelem(newpool, pzone->size, 0);
+    pzone->firstpool = newpool;
+    pzone->pools++;
+
+    // Thread it backwards so element 0 comes out first
+    while (n--) {
+      bmalfree_t *elem = getelem(newpool, pzone->size, n);
+      elem->next = p;
+      p = elem;
+    }
   }
+
+  pzone->freelist = p->next;
+
+  if (++pzone->used > pzone->peak)
+    pzone->peak = pzone->used;
+
+  return p;
 }
 
 void Z_BFree(struct block_memory_alloc_s *pzone, void* p)
 {
-  register bmalpool_t **pool = (bmalpool_t**)&(pzone->firstpool);
-
-  while (*pool != NULL) {
-    int n = iselem(*pool, pzone->size, p);
-    if (n >= 0) {
-      (*pool)->used[n] = unused_block;
-      if (memchr(((*pool)->used), used_block, (*pool)->blocks) == NULL) {
-  // Block is all unused, can be freed
-  bmalpool_t *oldpool = *pool;
-  *pool = (*pool)->nextpool;
-  Z_Free(oldpool);
-      }
-      return;
-    } else pool = &((*pool)->nextpool);
-  }
-  I_Error("Z_BFree: Free not in zone %s", pzone->desc);
+#ifdef RANGECHECK
+  const bmalpool_t *pool = pzone->firstpool;
+
+  while (pool && iselem(pool, pzone->size, p) < 0)
+    pool = pool->nextpool;
+
+  if (!pool)
+    I_Error("Z_BFree: Free not in zone %s", pzone->desc);
+#endif
+
+  ((bmalfree_t *)p)->next = pzone->freelist;
+  pzone->freelist = p;
+  pzone->used--;
+}
+
+void Z_BPrintStats(const struct block_memory_alloc_s *pzone)
+{
+  const int total = pzone->pools * (int)pzone->perpool;
+
+  lprintf(LO_INFO, "Z_BMalloc: %s %d/%d used (%d%%), %d peak, %d pools",
+          pzone->desc, pzone->used, total,
+          total ? (pzone->used * 100) / total : 0,
+          pzone->peak, pzone->pools);
 }
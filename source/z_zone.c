@@ -32,7 +32,19 @@
 //
 // There is never any space between memblocks,
 //  and there will never be two contiguous free memblocks.
-// The rover can be left pointing at a non-empty block.
+//
+// Free blocks are also kept on segregated free lists, two
+//  level as in TLSF. The first level is the power of two of
+//  the block size and the second splits that range into
+//  ZONE_SL_COUNT classes. A bitmap per level finds the
+//  smallest non empty class that fits in constant time.
+//
+// Purgable blocks are only thrown out by the rover when no
+//  free block fits, so cached lumps live as long as possible.
+//
+// PU_LEVEL blocks don't go through the lists at all. They are
+//  bumped out of a level arena made of zone chunks and are
+//  all released at once by Z_FreeTags at the end of the level.
 //
 // It is of no value to free a cachable block,
 //  because it will get overwritten automatically if needed.
@@ -40,6 +52,12 @@
 
 #define ZONEID	0x1d4a11
 
+#define ZONE_SL_LOG2    3
+#define ZONE_SL_COUNT   (1 << ZONE_SL_LOG2)
+#define ZONE_FL_COUNT   24      // memblock_t size is 24 bits.
+
+#define LEVELCHUNK      4096
+
 const unsigned int maxHeapSize = (256 * 1024);
 
 #ifndef GBA
@@ -55,16 +73,153 @@ typedef struct memblock_s
     struct memblock_s*	prev;
 } memblock_t;
 
+// A free block keeps its free list links where the user data was.
+typedef struct
+{
+    memblock_t* nextfree;
+    memblock_t* prevfree;
+} freelinks_t;
+
+#define FREELINKS(b) ((freelinks_t *)((byte *)(b) + sizeof(memblock_t)))
+
+// Every block must be able to hold the links once freed.
+#define MINBLOCK (sizeof(memblock_t) + sizeof(freelinks_t))
+
+// A level arena chunk: a PU_LEVEL zone block carved up by Z_LevelMalloc.
+typedef struct levelchunk_s
+{
+    struct levelchunk_s* next;
+} levelchunk_t;
+
+// Owned level allocations are preceded by one of these so the
+// owners can still be cleared when the arena is reset.
+typedef struct levelowner_s
+{
+    void** user;
+    struct levelowner_s* next;
+} levelowner_t;
 
 typedef struct
 {
     // start / end cap for linked list
     memblock_t	blocklist;
     memblock_t*	rover;
+
+    unsigned int flbitmap;
+    byte slbitmap[ZONE_FL_COUNT];
+    memblock_t* freelists[ZONE_FL_COUNT][ZONE_SL_COUNT];
+
+    levelchunk_t* levelchunks;
+    levelowner_t* levelowners;
+    byte* levelrover;
+    byte* levelend;
+    unsigned int levelbytes;
 } memzone_t;
 
 memzone_t*	mainzone;
 
+static int Z_HighBit(unsigned int x)
+{
+    return 31 - __builtin_clz(x);
+}
+
+static void Z_Mapping(unsigned int size, int* fl, int* sl)
+{
+    *fl = Z_HighBit(size);
+    *sl = (size >> (*fl - ZONE_SL_LOG2)) & (ZONE_SL_COUNT - 1);
+}
+
+static void Z_InsertFree(memblock_t* block)
+{
+    int fl, sl;
+
+    Z_Mapping(block->size, &fl, &sl);
+
+    memblock_t* head = mainzone->freelists[fl][sl];
+
+    FREELINKS(block)->nextfree = head;
+    FREELINKS(block)->prevfree = NULL;
+
+    if (head)
+        FREELINKS(head)->prevfree = block;
+
+    mainzone->freelists[fl][sl] = block;
+    mainzone->flbitmap |= 1u << fl;
+    mainzone->slbitmap[fl] |= 1 << sl;
+}
+
+static void Z_RemoveFree(memblock_t* block)
+{
+    int fl, sl;
+
+    Z_Mapping(block->size, &fl, &sl);
+
+    memblock_t* next = FREELINKS(block)->nextfree;
+    memblock_t* prev = FREELINKS(block)->prevfree;
+
+    if (next)
+        FREELINKS(next)->prevfree = prev;
+
+    if (prev)
+        FREELINKS(prev)->nextfree = next;
+    else
+    {
+        mainzone->freelists[fl][sl] = next;
+
+        if (!next)
+        {
+            mainzone->slbitmap[fl] &= ~(1 << sl);
+
+            if (!mainzone->slbitmap[fl])
+                mainzone->flbitmap &= ~(1u << fl);
+        }
+    }
+}
+
+//
+// Z_FindFree
+// Good fit: the size is rounded up to the next class so any
+// block on the list found is big enough. Failing that, the
+// class of the size itself may still hold a block that fits.
+//
+static memblock_t* Z_FindFree(unsigned int size)
+{
+    int fl, sl;
+    unsigned int bits;
+    memblock_t* block;
+
+    Z_Mapping(size + (1 << (Z_HighBit(size) - ZONE_SL_LOG2)) - 1, &fl, &sl);
+
+    if (fl < ZONE_FL_COUNT)
+    {
+        bits = mainzone->slbitmap[fl] & (~0u << sl);
+
+        if (!bits)
+        {
+            bits = mainzone->flbitmap & (~0u << (fl + 1));
+
+            if (bits)
+            {
+                fl = __builtin_ctz(bits);
+                bits = mainzone->slbitmap[fl];
+            }
+        }
+
+        if (bits)
+            return mainzone->freelists[fl][__builtin_ctz(bits)];
+    }
+
+    Z_Mapping(size, &fl, &sl);
+
+    for (block = mainzone->freelists[fl][sl]; block; block = FREELINKS(block)->nextfree)
+    {
+        if (block->size >= size)
+            return block;
+    }
+
+    return NULL;
+}
+
 //
 // Z_Init
 //
@@ -86,6 +241,8 @@ void Z_Init (void)
 
     lprintf(LO_INFO,"Z_Init: Heapsize is %d bytes.", heapSize);
 
+    memset(mainzone, 0, sizeof(memzone_t));
+
     // set the entire zone to one free block
     mainzone->blocklist.next =
     mainzone->blocklist.prev =
@@ -101,6 +258,8 @@ void Z_Init (void)
     block->user = NULL;
 
     block->size = heapSize - sizeof(memzone_t);
+
+    Z_InsertFree(block);
 }
 
 
@@ -141,6 +300,8 @@ void Z_Free (void* ptr)
     if (!other->user)
     {
         // merge with previous free block
+        Z_RemoveFree(other);
+
         other->size += block->size;
         other->next = block->next;
         other->next->prev = other;
@@ -155,6 +316,8 @@ void Z_Free (void* ptr)
     if (!other->user)
     {
         // merge the next free block onto the end
+        Z_RemoveFree(other);
+
         block->size += other->size;
         block->next = other->next;
         block->next->prev = block;
@@ -162,35 +325,22 @@ void Z_Free (void* ptr)
         if (other == mainzone->rover)
             mainzone->rover = block;
     }
-}
-
 
+    Z_InsertFree(block);
+}
 
 //
-// Z_Malloc
-// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+// Z_PurgeFor
+// No free block is big enough, so sweep the rover round the
+// zone throwing out purgable blocks until a run of them and
+// their free neighbours fits. The block returned is free.
 //
-#define MINFRAGMENT		64
-
-
-void* Z_Malloc(int size, int tag, void **user)
+static memblock_t* Z_PurgeFor(int size)
 {
-    int		extra;
     memblock_t*	start;
     memblock_t* rover;
-    memblock_t* newblock;
     memblock_t*	base;
 
-    size = (size + 3) & ~3;
-
-    // scan through the block list,
-    // looking for the first free block
-    // of sufficient size,
-    // throwing out any purgable blocks along the way.
-
-    // account for size of block header
-    size += sizeof(memblock_t);
-
     // if there is a free block behind the rover,
     //  back up over them
     base = mainzone->rover;
@@ -206,7 +356,12 @@ void* Z_Malloc(int size, int tag, void **user)
         if (rover == start)
         {
             // scanned all the way around the list
-            I_Error ("Z_Malloc: failed on allocation of %i bytes", size);
+            zonestats_t stats;
+
+            Z_GetStats(&stats);
+
+            I_Error ("Z_Malloc: failed on allocation of %i bytes\n%u free, largest %u",
+                     size, stats.freebytes, stats.largestfree);
         }
 
         if (rover->user)
@@ -233,6 +388,35 @@ void* Z_Malloc(int size, int tag, void **user)
 
     } while (base->user || base->size < size);
 
+    // next purge will start looking here
+    mainzone->rover = base->next;
+
+    return base;
+}
+
+#define MINFRAGMENT		64
+
+
+static void* Z_ZoneMalloc(int size, int tag, void **user)
+{
+    int		extra;
+    memblock_t* newblock;
+    memblock_t*	base;
+
+    size = (size + 3) & ~3;
+
+    // account for size of block header
+    size += sizeof(memblock_t);
+
+    if (size < (int)MINBLOCK)
+        size = MINBLOCK;
+
+    base = Z_FindFree(size);
+
+    if (!base)
+        base = Z_PurgeFor(size);
+
+    Z_RemoveFree(base);
 
     // found a block big enough
     extra = base->size - size;
@@ -252,6 +436,8 @@ void* Z_Malloc(int size, int tag, void **user)
 
         base->next = newblock;
         base->size = size;
+
+        Z_InsertFree(newblock);
     }
 
     if (user)
@@ -271,9 +457,6 @@ void* Z_Malloc(int size, int tag, void **user)
 
     base->tag = tag;
 
-    // next allocation will start looking here
-    mainzone->rover = base->next;
-
 #ifndef GBA
     running_count += base->size;
     printf("Alloc: %d (%d)\n", base->size, running_count);
@@ -282,6 +465,102 @@ void* Z_Malloc(int size, int tag, void **user)
     return (void *) ((byte *)base + sizeof(memblock_t));
 }
 
+//
+// Z_LevelMalloc
+// Bumps a block out of the current level chunk, with no header
+// of its own. Big blocks get a chunk to themselves so the
+// current one carries on filling up.
+//
+static void* Z_LevelMalloc(int size, void **user)
+{
+    levelchunk_t* chunk;
+    byte* ptr;
+
+    size = (size + 3) & ~3;
+
+    if (user)
+        size += sizeof(levelowner_t);
+
+    if (size > LEVELCHUNK / 4)
+    {
+        chunk = Z_ZoneMalloc(sizeof(levelchunk_t) + size, PU_LEVEL, NULL);
+        chunk->next = mainzone->levelchunks;
+        mainzone->levelchunks = chunk;
+
+        ptr = (byte *)(chunk + 1);
+    }
+    else
+    {
+        if (mainzone->levelend - mainzone->levelrover < size)
+        {
+            chunk = Z_ZoneMalloc(LEVELCHUNK, PU_LEVEL, NULL);
+            chunk->next = mainzone->levelchunks;
+            mainzone->levelchunks = chunk;
+
+            mainzone->levelrover = (byte *)(chunk + 1);
+            mainzone->levelend = (byte *)chunk + LEVELCHUNK;
+        }
+
+        ptr = mainzone->levelrover;
+        mainzone->levelrover += size;
+    }
+
+    mainzone->levelbytes += size;
+
+    if (user)
+    {
+        levelowner_t* owner = (levelowner_t *)ptr;
+
+        owner->user = user;
+        owner->next = mainzone->levelowners;
+        mainzone->levelowners = owner;
+
+        ptr += sizeof(levelowner_t);
+        *user = ptr;
+    }
+
+    return ptr;
+}
+
+//
+// Z_FreeLevel
+// Resets the level arena, clearing the owners first.
+//
+static void Z_FreeLevel(void)
+{
+    levelowner_t* owner;
+    levelchunk_t* chunk;
+    levelchunk_t* next;
+
+    for (owner = mainzone->levelowners; owner; owner = owner->next)
+        *owner->user = NULL;
+
+    for (chunk = mainzone->levelchunks; chunk; chunk = next)
+    {
+        next = chunk->next;
+        Z_Free(chunk);
+    }
+
+    mainzone->levelchunks = NULL;
+    mainzone->levelowners = NULL;
+    mainzone->levelrover = mainzone->levelend = NULL;
+    mainzone->levelbytes = 0;
+}
+
+//
+// Z_Malloc
+// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+// PU_LEVEL blocks come from the level arena and can't be freed
+// one at a time, use PU_LEVSPEC for those.
+//
+void* Z_Malloc(int size, int tag, void **user)
+{
+    if (tag == PU_LEVEL)
+        return Z_LevelMalloc(size, user);
+
+    return Z_ZoneMalloc(size, tag, user);
+}
+
 void* Z_Calloc(size_t count, size_t size, int tag, void **user)
 {
     const size_t bytes = count * size;
@@ -326,6 +605,21 @@ void* Z_Realloc(void *ptr, size_t n, int tag, void **user)
     return p;
 }
 
+//
+// Z_ChangeTag
+// Moves a block between purge levels, e.g. to lock a
+// cached lump in memory and later make it purgable again.
+//
+void Z_ChangeTag(void* ptr, int tag)
+{
+    memblock_t* block = (memblock_t *)((byte *)ptr - sizeof(memblock_t));
+
+    if (tag >= PU_PURGELEVEL && block->user < (void **)0x100)
+        I_Error("Z_ChangeTag: an owner is required for purgable blocks");
+
+    block->tag = tag;
+}
+
 //
 // Z_FreeTags
 //
@@ -334,6 +628,9 @@ void Z_FreeTags(int lowtag, int hightag)
     memblock_t*	block;
     memblock_t*	next;
 
+    if (lowtag <= PU_LEVEL && hightag >= PU_LEVEL)
+        Z_FreeLevel();
+
     for (block = mainzone->blocklist.next ;
          block != &mainzone->blocklist ;
          block = next)
@@ -374,4 +671,87 @@ void Z_CheckHeap (void)
         if (!block->user && !block->next->user)
             I_Error ("Z_CheckHeap: two consecutive free blocks\n");
     }
+
+    for (int fl = 0; fl < ZONE_FL_COUNT; fl++)
+    {
+        for (int sl = 0; sl < ZONE_SL_COUNT; sl++)
+        {
+            for (block = mainzone->freelists[fl][sl]; block; block = FREELINKS(block)->nextfree)
+            {
+                int bfl, bsl;
+
+                Z_Mapping(block->size, &bfl, &bsl);
+
+                if (block->user || bfl != fl || bsl != sl)
+                    I_Error ("Z_CheckHeap: bad block on free list\n");
+            }
+
+            if (!mainzone->freelists[fl][sl] != !(mainzone->slbitmap[fl] & (1 << sl)))
+                I_Error ("Z_CheckHeap: free list bitmap is wrong\n");
+        }
+    }
+}
+
+//
+// Z_GetStats
+// Walks the whole zone, so only for the odd report.
+// The largest free block comes from the highest non empty
+// free list, fragmentation is the share of free memory
+// that an allocation of that size could not use.
+//
+void Z_GetStats(zonestats_t* stats)
+{
+    memblock_t* block;
+
+    memset(stats, 0, sizeof(*stats));
+
+    for (block = mainzone->blocklist.next; block != &mainzone->blocklist; block = block->next)
+    {
+        if (!block->user)
+        {
+            stats->freebytes += block->size;
+            stats->freeblocks++;
+        }
+        else
+        {
+            if (block->tag >= PU_PURGELEVEL)
+                stats->purgablebytes += block->size;
+
+            stats->usedblocks++;
+        }
+    }
+
+    if (mainzone->flbitmap)
+    {
+        const int fl = Z_HighBit(mainzone->flbitmap);
+        const int sl = Z_HighBit(mainzone->slbitmap[fl]);
+
+        for (block = mainzone->freelists[fl][sl]; block; block = FREELINKS(block)->nextfree)
+        {
+            if (block->size > stats->largestfree)
+                stats->largestfree = block->size;
+        }
+    }
+
+    for (levelchunk_t* chunk = mainzone->levelchunks; chunk; chunk = chunk->next)
+        stats->levelchunks++;
+
+    stats->levelbytes = mainzone->levelbytes;
+
+    if (stats->freebytes)
+        stats->fragmentation = 100 - (int)(((unsigned long long)stats->largestfree * 100) / stats->freebytes);
+}
+
+void Z_PrintStats(void)
+{
+    zonestats_t stats;
+
+    Z_GetStats(&stats);
+
+    lprintf(LO_INFO, "Z_Stats: %uK free in %d blocks, largest %uK, %d%% fragmented, %uK purgable, %d used blocks",
+            stats.freebytes >> 10, stats.freeblocks, stats.largestfree >> 10,
+            stats.fragmentation, stats.purgablebytes >> 10, stats.usedblocks);
+
+    lprintf(LO_INFO, "Z_Stats: %uK level data in %d chunks",
+            stats.levelbytes >> 10, stats.levelchunks);
 }
@@ -0,0 +1,360 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blockmap.h"
+#include "mapdata.h"
+
+//
+// The engine reads the lump as
+//
+//   orgx, orgy, width, height
+//   width * height list offsets, in shorts from the start of the lump
+//   line lists, each ended by -1
+//
+// and P_BlockLinesIterator skips the first word of every list, which
+// doombsp always writes as 0. Rather than store that word, offsets
+// here point one short before the list, at the end of whatever comes
+// before it. That lets a list that is the tail of another share it.
+//
+// The word after the offset table is BLOCKMAP_MAGIC | log2(units),
+// which P_LoadBlockMap uses to pick up a cell size other than 128.
+//
+
+#define BLOCKMAP_MAGIC  0x7f00
+
+typedef struct
+{
+    short* lines;
+    int count, max;
+} blocklist_t;
+
+static void AddLine(blocklist_t* list, int line)
+{
+    for(int i = 0; i < list->count; i++)
+    {
+        if(list->lines[i] == line)
+            return;
+    }
+
+    if(list->count == list->max)
+    {
+        list->max = list->max * 2 + 8;
+        list->lines = realloc(list->lines, list->max * sizeof(short));
+    }
+
+    list->lines[list->count++] = line;
+}
+
+//
+// OldLists
+// The lines P_BlockLinesIterator sees in each block of the lump.
+//
+static int OldLists(const map_t* map, blocklist_t* lists, int numblocks)
+{
+    const short* bm = map->blockmap;
+
+    for(int i = 0; i < numblocks; i++)
+    {
+        int pos = (unsigned short)bm[4 + i] + 1;
+
+        for(; pos < map->blockmapsize && bm[pos] != -1; pos++)
+        {
+            if(bm[pos] < 0 || bm[pos] >= map->numlines)
+                return 0;
+
+            AddLine(&lists[i], bm[pos]);
+        }
+
+        if(pos >= map->blockmapsize)
+            return 0;
+    }
+
+    return 1;
+}
+
+//
+// LineTouchesBox
+// Liang-Barsky against the closed box, so lines along a block edge
+// land in both blocks.
+//
+static int LineTouchesBox(const wline_t* l, double x0, double y0, double x1, double y1)
+{
+    const double ax = l->v1.x / 65536.0, ay = l->v1.y / 65536.0;
+    const double dx = (l->v2.x - l->v1.x) / 65536.0, dy = (l->v2.y - l->v1.y) / 65536.0;
+
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { ax - x0, x1 - ax, ay - y0, y1 - ay };
+
+    double t0 = 0, t1 = 1;
+
+    for(int i = 0; i < 4; i++)
+    {
+        if(p[i] == 0)
+        {
+            if(q[i] < 0)
+                return 0;
+
+            continue;
+        }
+
+        const double t = q[i] / p[i];
+
+        if(p[i] < 0)
+        {
+            if(t > t1)
+                return 0;
+
+            if(t > t0)
+                t0 = t;
+        }
+        else
+        {
+            if(t < t0)
+                return 0;
+
+            if(t < t1)
+                t1 = t;
+        }
+    }
+
+    return 1;
+}
+
+//
+// NewLists
+// Every line in every block it touches, in line order so the engine
+// walks lines[] and linedata[] forwards.
+//
+static void NewLists(const map_t* map, blocklist_t* lists, int orgx, int orgy, int width, int height, int units)
+{
+    for(int i = 0; i < map->numlines; i++)
+    {
+        const wline_t* l = &map->lines[i];
+
+        const double minx = (l->v1.x < l->v2.x ? l->v1.x : l->v2.x) / 65536.0 - orgx;
+        const double maxx = (l->v1.x > l->v2.x ? l->v1.x : l->v2.x) / 65536.0 - orgx;
+        const double miny = (l->v1.y < l->v2.y ? l->v1.y : l->v2.y) / 65536.0 - orgy;
+        const double maxy = (l->v1.y > l->v2.y ? l->v1.y : l->v2.y) / 65536.0 - orgy;
+
+        int bx0 = (int)(minx / units) - 1, bx1 = (int)(maxx / units) + 1;
+        int by0 = (int)(miny / units) - 1, by1 = (int)(maxy / units) + 1;
+
+        if(bx0 < 0) bx0 = 0;
+        if(by0 < 0) by0 = 0;
+        if(bx1 >= width) bx1 = width - 1;
+        if(by1 >= height) by1 = height - 1;
+
+        for(int by = by0; by <= by1; by++)
+        {
+            for(int bx = bx0; bx <= bx1; bx++)
+            {
+                const double x0 = orgx + bx * units, y0 = orgy + by * units;
+
+                if(LineTouchesBox(l, x0, y0, x0 + units, y0 + units))
+                    AddLine(&lists[by * width + bx], i);
+            }
+        }
+    }
+}
+
+// Compares two lists back to front, for tail sharing.
+static const blocklist_t* sortlists;
+
+static int CompareTails(const void* a, const void* b)
+{
+    const blocklist_t* la = &sortlists[*(const int*)a];
+    const blocklist_t* lb = &sortlists[*(const int*)b];
+
+    for(int i = 1; i <= la->count && i <= lb->count; i++)
+    {
+        const int x = la->lines[la->count - i], y = lb->lines[lb->count - i];
+
+        if(x != y)
+            return x - y;
+    }
+
+    return la->count - lb->count;
+}
+
+static int IsTail(const blocklist_t* tail, const blocklist_t* list)
+{
+    if(tail->count > list->count)
+        return 0;
+
+    return !memcmp(tail->lines, list->lines + list->count - tail->count, tail->count * sizeof(short));
+}
+
+//
+// WriteLump
+// Lists are laid out in the order blocks first use them, so
+// neighbouring blocks mostly read neighbouring flash.
+//
+static short* WriteLump(const blocklist_t* lists, int orgx, int orgy, int width, int height, int shift, int* size)
+{
+    const int numblocks = width * height;
+
+    // Each list either owns its storage or is the tail of the list after it.
+    int* order = malloc((numblocks + 1) * sizeof(int));
+    int* owner = malloc((numblocks + 1) * sizeof(int));
+
+    for(int i = 0; i < numblocks; i++)
+        order[i] = i;
+
+    sortlists = lists;
+    qsort(order, numblocks, sizeof(int), CompareTails);
+
+    for(int k = numblocks - 1; k >= 0; k--)
+    {
+        const int i = order[k];
+
+        owner[i] = i;
+
+        if(k + 1 < numblocks && IsTail(&lists[i], &lists[order[k + 1]]))
+            owner[i] = owner[order[k + 1]];
+    }
+
+    int total = 4 + numblocks + 1;
+
+    for(int i = 0; i < numblocks; i++)
+    {
+        if(owner[i] == i)
+            total += lists[i].count + 1;
+    }
+
+    short* lump = calloc(total, sizeof(short));
+    int* start = malloc((numblocks + 1) * sizeof(int));
+    int pos = 4 + numblocks + 1;
+
+    lump[0] = orgx;
+    lump[1] = orgy;
+    lump[2] = width;
+    lump[3] = height;
+    lump[4 + numblocks] = BLOCKMAP_MAGIC | shift;
+
+    for(int i = 0; i < numblocks; i++)
+        start[i] = -1;
+
+    for(int i = 0; i < numblocks; i++)
+    {
+        const int o = owner[i];
+
+        if(start[o] < 0)
+        {
+            start[o] = pos;
+            memcpy(lump + pos, lists[o].lines, lists[o].count * sizeof(short));
+            pos += lists[o].count;
+            lump[pos++] = -1;
+        }
+
+        lump[4 + i] = start[o] + lists[o].count - lists[i].count - 1;
+    }
+
+    free(start);
+    free(owner);
+    free(order);
+
+    *size = total;
+
+    return lump;
+}
+
+static void BuildMapBlockmap(wad_t* wad, const map_t* map, int units)
+{
+    const short* bm = map->blockmap;
+
+    if(map->blockmapsize < 4)
+        return;
+
+    int orgx = bm[0], orgy = bm[1];
+    int width = bm[2], height = bm[3];
+    int shift = 7;
+
+    if(units)
+    {
+        for(shift = 0; (1 << shift) < units; shift++)
+            ;
+
+        // Keep the origin, it is somewhere left of and below every line.
+        int maxx = orgx, maxy = orgy;
+
+        for(int i = 0; i < map->numlines; i++)
+        {
+            const wline_t* l = &map->lines[i];
+            const int xs[2] = { l->v1.x >> 16, l->v2.x >> 16 }, ys[2] = { l->v1.y >> 16, l->v2.y >> 16 };
+
+            for(int k = 0; k < 2; k++)
+            {
+                if(xs[k] < orgx) orgx = xs[k];
+                if(ys[k] < orgy) orgy = ys[k];
+                if(xs[k] > maxx) maxx = xs[k];
+                if(ys[k] > maxy) maxy = ys[k];
+            }
+        }
+
+        width = (maxx - orgx) / units + 1;
+        height = (maxy - orgy) / units + 1;
+    }
+    else if(map->blockmapsize < 4 + width * height)
+    {
+        fprintf(stderr, "%s: BLOCKMAP is damaged, left alone\n", map->name);
+        return;
+    }
+
+    const int numblocks = width * height;
+    blocklist_t* lists = calloc(numblocks + 1, sizeof(blocklist_t));
+
+    int ok = 1;
+
+    if(units)
+        NewLists(map, lists, orgx, orgy, width, height, units);
+    else
+        ok = OldLists(map, lists, numblocks);
+
+    int size = 0;
+    short* lump = ok ? WriteLump(lists, orgx, orgy, width, height, shift, &size) : NULL;
+
+    long entries = 0;
+
+    for(int i = 0; i < numblocks; i++)
+    {
+        entries += lists[i].count;
+        free(lists[i].lines);
+    }
+
+    free(lists);
+
+    if(!ok)
+    {
+        fprintf(stderr, "%s: BLOCKMAP is damaged, left alone\n", map->name);
+        return;
+    }
+
+    printf("%.8s: BLOCKMAP %dx%d blocks of %d, %.1f lines a block, %d -> %d bytes\n",
+           map->name, width, height, 1 << shift, numblocks ? (double)entries / numblocks : 0.0,
+           map->blockmapsize * 2, size * 2);
+
+    if(size > 0xffff)
+    {
+        fprintf(stderr, "%s: BLOCKMAP too big for 16 bit offsets, left alone\n", map->name);
+        free(lump);
+        return;
+    }
+
+    WAD_SetLump(wad, map->marker + ML_BLOCKMAP, (byte*)lump, size * 2);
+}
+
+void BuildBlockmap(wad_t* wad, int units)
+{
+    for(int marker = MAP_Find(wad, 0); marker >= 0; marker = MAP_Find(wad, marker + 1))
+    {
+        map_t map;
+
+        if(!MAP_Load(wad, marker, &map))
+            continue;
+
+        BuildMapBlockmap(wad, &map, units);
+
+        MAP_Free(&map);
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef BLOCKMAP_H
+#define BLOCKMAP_H
+
+//
+// BLOCKMAP builder.
+//
+
+#include "wadfile.h"
+
+// Rewrites the BLOCKMAP lump of every map with duplicate entries
+// removed and identical or tail-matching lists stored once. With units
+// 0 each block keeps the lines it had, in the same order, so play is
+// unchanged. With units 128, 64 or 32 the lists are worked out again
+// from the lines at that cell size.
+void BuildBlockmap(wad_t* wad, int units);
+
+#endif // BLOCKMAP_H
@@ -0,0 +1,134 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "lz4enc.h"
+
+#define MINMATCH    4
+#define LASTLITERALS 5      // The last 5 bytes are always literals.
+#define MFLIMIT     12      // No match may start in the last 12 bytes.
+#define MAXOFFSET   65535
+
+#define HASHBITS    15
+#define MAXCHAIN    256     // Match candidates tried per position.
+
+static unsigned int Hash4(const unsigned char* p)
+{
+    const unsigned int v = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+
+    return (v * 2654435761u) >> (32 - HASHBITS);
+}
+
+static unsigned char* WriteLength(unsigned char* op, int len)
+{
+    while(len >= 255)
+    {
+        *op++ = 255;
+        len -= 255;
+    }
+
+    *op++ = (unsigned char)len;
+
+    return op;
+}
+
+static unsigned char* WriteSequence(unsigned char* op, const unsigned char* lit, int litlen, int offset, int matchlen)
+{
+    unsigned char* token = op++;
+
+    *token = (unsigned char)((litlen >= 15 ? 15 : litlen) << 4);
+
+    if(litlen >= 15)
+        op = WriteLength(op, litlen - 15);
+
+    memcpy(op, lit, litlen);
+    op += litlen;
+
+    if(matchlen)
+    {
+        *op++ = offset & 0xff;
+        *op++ = offset >> 8;
+
+        matchlen -= MINMATCH;
+
+        *token |= (matchlen >= 15 ? 15 : matchlen);
+
+        if(matchlen >= 15)
+            op = WriteLength(op, matchlen - 15);
+    }
+
+    return op;
+}
+
+static void Insert(const unsigned char* src, int pos, int* head, int* chain)
+{
+    const unsigned int h = Hash4(src + pos);
+
+    chain[pos] = head[h];
+    head[h] = pos;
+}
+
+//
+// LZ4_Compress
+// Greedy parse over a hash chain. Slow but only run offline,
+// and the decoder cost doesn't depend on how hard we searched.
+//
+int LZ4_Compress(const unsigned char* src, int srclen, unsigned char* dest)
+{
+    unsigned char* op = dest;
+
+    int* head = malloc(sizeof(int) << HASHBITS);
+    int* chain = malloc(sizeof(int) * (srclen ? srclen : 1));
+
+    for(int i = 0; i < (1 << HASHBITS); i++)
+        head[i] = -1;
+
+    int anchor = 0;
+    int pos = 0;
+
+    const int matchlimit = srclen - LASTLITERALS;
+
+    while(pos < srclen - MFLIMIT)
+    {
+        int bestlen = 0;
+        int bestpos = 0;
+        int tries = MAXCHAIN;
+
+        for(int cand = head[Hash4(src + pos)]; cand >= 0 && pos - cand <= MAXOFFSET && tries--; cand = chain[cand])
+        {
+            int len = 0;
+
+            while(pos + len < matchlimit && src[cand + len] == src[pos + len])
+                len++;
+
+            if(len > bestlen)
+            {
+                bestlen = len;
+                bestpos = cand;
+            }
+        }
+
+        if(bestlen < MINMATCH)
+        {
+            Insert(src, pos, head, chain);
+            pos++;
+            continue;
+        }
+
+        op = WriteSequence(op, src + anchor, pos - anchor, pos - bestpos, bestlen);
+
+        for(int end = pos + bestlen; pos < end; pos++)
+        {
+            if(pos < srclen - MFLIMIT)
+                Insert(src, pos, head, chain);
+        }
+
+        anchor = pos;
+    }
+
+    op = WriteSequence(op, src + anchor, srclen - anchor, 0, 0);
+
+    free(chain);
+    free(head);
+
+    return (int)(op - dest);
+}
@@ -0,0 +1,15 @@
+#ifndef LZ4ENC_H
+#define LZ4ENC_H
+
+//
+// LZ4 block encoder, the counterpart of W_LZDecompress.
+//
+
+// Worst case output size for len input bytes.
+#define LZ4_BOUND(len) ((len) + ((len) / 255) + 16)
+
+// Compresses src into dest, which must hold LZ4_BOUND(srclen) bytes.
+// Returns the compressed length.
+int LZ4_Compress(const unsigned char* src, int srclen, unsigned char* dest);
+
+#endif // LZ4ENC_H
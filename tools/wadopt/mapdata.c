@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mapdata.h"
+#include "w_lz.h"
+
+_Static_assert(sizeof(wvertex_t) == 8, "vertex_t mirror");
+_Static_assert(sizeof(wline_t) == 56, "line_t mirror");
+_Static_assert(sizeof(wseg_t) == 32, "seg_t mirror");
+
+static const char* const mllumps[] =
+{
+    [ML_THINGS] = "THINGS",
+    [ML_LINEDEFS] = "LINEDEFS",
+    [ML_SIDEDEFS] = "SIDEDEFS",
+    [ML_VERTEXES] = "VERTEXES",
+    [ML_SEGS] = "SEGS",
+    [ML_SSECTORS] = "SSECTORS",
+    [ML_NODES] = "NODES",
+    [ML_SECTORS] = "SECTORS",
+    [ML_REJECT] = "REJECT",
+    [ML_BLOCKMAP] = "BLOCKMAP",
+};
+
+int MAP_Find(const wad_t* wad, int start)
+{
+    for(int i = start; i + ML_BLOCKMAP < wad->numlumps; i++)
+    {
+        int ok = 1;
+
+        for(int j = ML_THINGS; j <= ML_BLOCKMAP && ok; j++)
+            ok = WAD_NameIs(&wad->lumps[i + j], mllumps[j]);
+
+        if(ok)
+            return i;
+    }
+
+    return -1;
+}
+
+//
+// CopyLump
+// Returns a private, decompressed copy of a lump
+// and the number of whole records in it.
+//
+static void* CopyLump(const wad_t* wad, int lump, int recsize, int* count)
+{
+    const wadlump_t* l = &wad->lumps[lump];
+    const int size = (l->flags & LUMPF_COMPRESSED) ? l->rawsize : l->size;
+
+    byte* data = calloc(size ? size : 1, 1);
+
+    if(l->flags & LUMPF_COMPRESSED)
+    {
+        if(W_LZDecompress(l->data + 4, l->size - 4, data, size) != size)
+        {
+            free(data);
+            return NULL;
+        }
+    }
+    else
+        memcpy(data, l->data, size);
+
+    *count = size / recsize;
+
+    return data;
+}
+
+int MAP_Load(const wad_t* wad, int marker, map_t* map)
+{
+    memset(map, 0, sizeof(*map));
+
+    map->marker = marker;
+    memcpy(map->name, wad->lumps[marker].name, 8);
+
+    map->things = CopyLump(wad, marker + ML_THINGS, sizeof(mapthing_t), &map->numthings);
+    map->vertexes = CopyLump(wad, marker + ML_VERTEXES, sizeof(wvertex_t), &map->numvertexes);
+    map->lines = CopyLump(wad, marker + ML_LINEDEFS, sizeof(wline_t), &map->numlines);
+    map->sides = CopyLump(wad, marker + ML_SIDEDEFS, sizeof(mapsidedef_t), &map->numsides);
+    map->sectors = CopyLump(wad, marker + ML_SECTORS, sizeof(mapsector_t), &map->numsectors);
+    map->segs = CopyLump(wad, marker + ML_SEGS, sizeof(wseg_t), &map->numsegs);
+    map->subsectors = CopyLump(wad, marker + ML_SSECTORS, sizeof(mapsubsector_t), &map->numsubsectors);
+    map->nodes = CopyLump(wad, marker + ML_NODES, sizeof(mapnode_t), &map->numnodes);
+
+    map->blockmap = CopyLump(wad, marker + ML_BLOCKMAP, sizeof(short), &map->blockmapsize);
+
+    int rejectsize;
+    byte* reject = CopyLump(wad, marker + ML_REJECT, 1, &rejectsize);
+
+    const int fullsize = (map->numsectors * map->numsectors + 7) / 8;
+
+    if(reject)
+    {
+        map->reject = calloc(fullsize ? fullsize : 1, 1);
+        memcpy(map->reject, reject, rejectsize < fullsize ? rejectsize : fullsize);
+        free(reject);
+    }
+
+    if(!map->things || !map->vertexes || !map->lines || !map->sides || !map->sectors ||
+       !map->segs || !map->subsectors || !map->nodes || !map->reject || !map->blockmap)
+    {
+        fprintf(stderr, "%s: can't read map lumps\n", map->name);
+        MAP_Free(map);
+        return 0;
+    }
+
+    // Same fallback as P_LoadSideDefs2.
+    for(int i = 0; i < map->numsides; i++)
+    {
+        if((unsigned short)map->sides[i].sector >= map->numsectors)
+        {
+            fprintf(stderr, "%s: sidedef %d has a bad sector\n", map->name, i);
+            map->sides[i].sector = 0;
+        }
+    }
+
+    return 1;
+}
+
+void MAP_Free(map_t* map)
+{
+    free(map->things);
+    free(map->vertexes);
+    free(map->lines);
+    free(map->sides);
+    free(map->sectors);
+    free(map->segs);
+    free(map->subsectors);
+    free(map->nodes);
+    free(map->reject);
+    free(map->blockmap);
+
+    memset(map, 0, sizeof(*map));
+}
+
+int MAP_FrontSector(const map_t* map, const wline_t* line)
+{
+    if(line->sidenum[0] >= map->numsides)
+        return -1;
+
+    return map->sides[line->sidenum[0]].sector;
+}
+
+int MAP_BackSector(const map_t* map, const wline_t* line)
+{
+    if(!(line->flags & ML_TWOSIDED) || line->sidenum[1] >= map->numsides)
+        return -1;
+
+    return map->sides[line->sidenum[1]].sector;
+}
@@ -0,0 +1,91 @@
+#ifndef MAPDATA_H
+#define MAPDATA_H
+
+//
+// Map lumps of a GbaWadUtil processed wad, for the offline passes.
+//
+// GbaWadUtil has already turned VERTEXES, LINEDEFS and SEGS into the
+// engine's runtime vertex_t, line_t and seg_t (r_defs.h) so they can
+// be used in place from flash. The mirrors below must match those.
+// The remaining lumps keep their doomdata.h layout.
+//
+
+#include "wadfile.h"
+#include "doomdata.h"
+
+typedef struct
+{
+    int x, y;                   // fixed_t
+} wvertex_t;
+
+typedef struct
+{
+    wvertex_t v1, v2;
+    unsigned int lineno;
+    int dx, dy;
+    unsigned short sidenum[2];
+    int bbox[4];
+    unsigned short flags;
+    short special;
+    short tag;
+    short slopetype;
+} wline_t;
+
+typedef struct
+{
+    wvertex_t v1, v2;
+    int offset;
+    unsigned int angle;
+    unsigned short sidenum;
+    unsigned short linenum;
+    unsigned short frontsectornum;
+    unsigned short backsectornum;
+} wseg_t;
+
+typedef struct
+{
+    int marker;                 // lump number of the ExMy / MAPxx label
+    char name[9];
+
+    mapthing_t* things;
+    int numthings;
+
+    wvertex_t* vertexes;
+    int numvertexes;
+
+    wline_t* lines;
+    int numlines;
+
+    mapsidedef_t* sides;
+    int numsides;
+
+    mapsector_t* sectors;
+    int numsectors;
+
+    wseg_t* segs;
+    int numsegs;
+
+    mapsubsector_t* subsectors;
+    int numsubsectors;
+
+    mapnode_t* nodes;
+    int numnodes;
+
+    byte* reject;               // numsectors^2 bits, zero filled if short
+
+    short* blockmap;
+    int blockmapsize;           // in shorts
+} map_t;
+
+// Next map label at or after lump start, -1 if there are no more.
+int  MAP_Find(const wad_t* wad, int start);
+
+// Copies (and decompresses) the map's lumps. Returns 0 if they are damaged.
+int  MAP_Load(const wad_t* wad, int marker, map_t* map);
+void MAP_Free(map_t* map);
+
+// Sector on each side of a line, -1 for none.
+int  MAP_FrontSector(const map_t* map, const wline_t* line);
+int  MAP_BackSector(const map_t* map, const wline_t* line);
+
+#endif // MAPDATA_H
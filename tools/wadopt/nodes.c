@@ -0,0 +1,607 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "nodes.h"
+#include "mapdata.h"
+#include "sweep.h"
+
+//
+// A plain recursive BSP builder in the doombsp mould: every seg's line
+// is tried as the partition and the cheapest wins. The cost is shaped
+// by what R_RenderBSPNode and R_AddLine spend their time on:
+//
+//  - A split seg costs two R_AddLine calls wherever it is seen, and in
+//    busy parts of the map that is often. Splits are charged by the
+//    weight of the seg.
+//  - A seg's weight grows with the things in its sector. Things are
+//    where the player goes, and balancing by weight rather than count
+//    puts those areas higher up the tree.
+//  - Axis aligned partitions take R_PointOnSide's early outs, so
+//    sloped ones pay a little extra.
+//
+// Partitions are whole map units so they fit mapnode_t; split points
+// are kept as fixed_t in the segs.
+//
+
+#define EPS             (1.0 / 256)     // map units either side of a partition
+#define MAXDEPTH        60              // R_RenderBSPNode stacks two ints a level in 128
+
+typedef struct
+{
+    double splitcost;       // per unit of seg weight split
+    double slopecost;       // for a partition that is not axis aligned
+    double thingweight;     // extra seg weight per thing in its sector
+} nodeparams_t;
+
+static const nodeparams_t tunings[] =
+{
+    { 8, 0, 0 },            // close to the classic seg count / balance trade
+    { 4, 2, 0.25 },
+    { 12, 2, 0.25 },
+    { 24, 4, 0.5 },
+};
+
+#define NUMTUNINGS  (int)(sizeof(tunings) / sizeof(tunings[0]))
+
+typedef struct
+{
+    int x1, y1, x2, y2;     // fixed_t
+    int key;                // line * 2 + side
+    int offset;             // fixed_t, from the start of the side
+    double weight;
+} bseg_t;
+
+// What a seg of one side of a line looks like, from the old segs.
+typedef struct
+{
+    int used;
+    unsigned int angle;
+    unsigned short sidenum;
+    unsigned short frontsectornum;
+    unsigned short backsectornum;
+    int offset;             // offset of the side's first seg
+} sidetemplate_t;
+
+typedef struct
+{
+    int px, py, dx, dy;     // map units
+    double len;
+} partition_t;
+
+typedef struct
+{
+    const map_t* map;
+    const nodeparams_t* params;
+    const sidetemplate_t* sides;
+
+    int* linemark;
+    int stamp;
+
+    wseg_t* segs;
+    int numsegs, maxsegs;
+
+    mapsubsector_t* subsectors;
+    int numsubsectors, maxsubsectors;
+
+    mapnode_t* nodes;
+    int numnodes, maxnodes;
+
+    int forced;             // leaves that are not convex, no partition helped
+} build_t;
+
+enum { SIDE_FRONT, SIDE_BACK, SIDE_SPLIT };
+
+static double Dist(const partition_t* p, int x, int y)
+{
+    return (p->dx * (y / 65536.0 - p->py) - p->dy * (x / 65536.0 - p->px)) / p->len;
+}
+
+static int Classify(const partition_t* p, const bseg_t* seg, double* da, double* db)
+{
+    *da = Dist(p, seg->x1, seg->y1);
+    *db = Dist(p, seg->x2, seg->y2);
+
+    if(fabs(*da) <= EPS && fabs(*db) <= EPS)
+    {
+        const double dot = (double)(seg->x2 - seg->x1) * p->dx + (double)(seg->y2 - seg->y1) * p->dy;
+
+        return dot > 0 ? SIDE_FRONT : SIDE_BACK;
+    }
+
+    // R_PointOnSide: the right of the partition is the front.
+    if(*da <= EPS && *db <= EPS)
+        return SIDE_FRONT;
+
+    if(*da >= -EPS && *db >= -EPS)
+        return SIDE_BACK;
+
+    return SIDE_SPLIT;
+}
+
+//
+// SegPartition
+// The line a seg lies on, if it fits a mapnode_t.
+//
+static int SegPartition(const build_t* b, const bseg_t* seg, partition_t* p)
+{
+    const wline_t* l = &b->map->lines[seg->key >> 1];
+    const wvertex_t* a = (seg->key & 1) ? &l->v2 : &l->v1;
+    const wvertex_t* c = (seg->key & 1) ? &l->v1 : &l->v2;
+
+    if((a->x | a->y | c->x | c->y) & 0xffff)
+        return 0;
+
+    p->px = a->x >> 16;
+    p->py = a->y >> 16;
+    p->dx = (c->x - a->x) >> 16;
+    p->dy = (c->y - a->y) >> 16;
+
+    if(p->px < -32768 || p->px > 32767 || p->py < -32768 || p->py > 32767 ||
+       p->dx < -32768 || p->dx > 32767 || p->dy < -32768 || p->dy > 32767)
+        return 0;
+
+    p->len = sqrt((double)p->dx * p->dx + (double)p->dy * p->dy);
+
+    return p->len > 0;
+}
+
+static int IsLeaf(const build_t* b, const bseg_t* segs, int n)
+{
+    const int sector = b->sides[segs[0].key].frontsectornum;
+
+    for(int i = 0; i < n; i++)
+    {
+        if(b->sides[segs[i].key].frontsectornum != sector)
+            return 0;
+
+        const double dx = (segs[i].x2 - segs[i].x1) / 65536.0;
+        const double dy = (segs[i].y2 - segs[i].y1) / 65536.0;
+        const partition_t p = { 0, 0, 0, 0, sqrt(dx * dx + dy * dy) };
+
+        for(int j = 0; j < n; j++)
+        {
+            if(j == i)
+                continue;
+
+            // Everything else must be on this seg's front.
+            const double ax = (segs[j].x1 - segs[i].x1) / 65536.0, ay = (segs[j].y1 - segs[i].y1) / 65536.0;
+            const double bx = (segs[j].x2 - segs[i].x1) / 65536.0, by = (segs[j].y2 - segs[i].y1) / 65536.0;
+
+            if((dx * ay - dy * ax) / p.len > EPS || (dx * by - dy * bx) / p.len > EPS)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+//
+// Evaluate
+// Cost of splitting with p, or -1 if it leaves one side empty
+// or can't beat best.
+//
+static double Evaluate(const build_t* b, const partition_t* p, const bseg_t* segs, int n, double best)
+{
+    double front = 0, back = 0, split = 0;
+    int nfront = 0, nback = 0;
+
+    double cost = (p->dx && p->dy) ? b->params->slopecost : 0;
+
+    for(int i = 0; i < n; i++)
+    {
+        double da, db;
+
+        switch(Classify(p, &segs[i], &da, &db))
+        {
+            case SIDE_FRONT:
+                front += segs[i].weight;
+                nfront++;
+                break;
+
+            case SIDE_BACK:
+                back += segs[i].weight;
+                nback++;
+                break;
+
+            default:
+                front += segs[i].weight;
+                back += segs[i].weight;
+                split += segs[i].weight;
+                nfront++;
+                nback++;
+
+                if(best >= 0 && cost + split * b->params->splitcost > best)
+                    return -1;
+        }
+    }
+
+    if(!nfront || !nback)
+        return -1;
+
+    cost += split * b->params->splitcost + fabs(front - back);
+
+    return (best >= 0 && cost >= best) ? -1 : cost;
+}
+
+static void SegBox(const bseg_t* segs, int n, short* box)
+{
+    int top = segs[0].y1, bottom = segs[0].y1, left = segs[0].x1, right = segs[0].x1;
+
+    for(int i = 0; i < n; i++)
+    {
+        const int xs[2] = { segs[i].x1, segs[i].x2 }, ys[2] = { segs[i].y1, segs[i].y2 };
+
+        for(int k = 0; k < 2; k++)
+        {
+            if(xs[k] < left) left = xs[k];
+            if(xs[k] > right) right = xs[k];
+            if(ys[k] < bottom) bottom = ys[k];
+            if(ys[k] > top) top = ys[k];
+        }
+    }
+
+    // Round outwards to whole map units.
+    box[BOXTOP] = (top + 0xffff) >> 16;
+    box[BOXBOTTOM] = bottom >> 16;
+    box[BOXLEFT] = left >> 16;
+    box[BOXRIGHT] = (right + 0xffff) >> 16;
+}
+
+static int EmitSubsector(build_t* b, const bseg_t* segs, int n)
+{
+    if(b->numsegs + n > b->maxsegs)
+    {
+        b->maxsegs = (b->numsegs + n) * 2;
+        b->segs = realloc(b->segs, b->maxsegs * sizeof(wseg_t));
+    }
+
+    if(b->numsubsectors == b->maxsubsectors)
+    {
+        b->maxsubsectors = b->maxsubsectors * 2 + 64;
+        b->subsectors = realloc(b->subsectors, b->maxsubsectors * sizeof(mapsubsector_t));
+    }
+
+    mapsubsector_t* ss = &b->subsectors[b->numsubsectors];
+
+    ss->numsegs = n;
+    ss->firstseg = b->numsegs;
+
+    for(int i = 0; i < n; i++)
+    {
+        const sidetemplate_t* t = &b->sides[segs[i].key];
+        wseg_t* out = &b->segs[b->numsegs++];
+
+        out->v1.x = segs[i].x1;
+        out->v1.y = segs[i].y1;
+        out->v2.x = segs[i].x2;
+        out->v2.y = segs[i].y2;
+        out->offset = segs[i].offset;
+        out->angle = t->angle;
+        out->sidenum = t->sidenum;
+        out->linenum = segs[i].key >> 1;
+        out->frontsectornum = t->frontsectornum;
+        out->backsectornum = t->backsectornum;
+    }
+
+    return NF_SUBSECTOR | b->numsubsectors++;
+}
+
+static int Build(build_t* b, bseg_t* segs, int n, int depth)
+{
+    if(IsLeaf(b, segs, n))
+        return EmitSubsector(b, segs, n);
+
+    partition_t best, p;
+    double bestcost = -1;
+
+    b->stamp++;
+
+    for(int i = 0; i < n; i++)
+    {
+        const int line = segs[i].key >> 1;
+
+        if(b->linemark[line] == b->stamp)
+            continue;
+
+        b->linemark[line] = b->stamp;
+
+        if(!SegPartition(b, &segs[i], &p))
+            continue;
+
+        const double cost = Evaluate(b, &p, segs, n, bestcost);
+
+        if(cost >= 0)
+        {
+            bestcost = cost;
+            best = p;
+        }
+    }
+
+    if(bestcost < 0 || depth >= MAXDEPTH)
+    {
+        b->forced++;
+        return EmitSubsector(b, segs, n);
+    }
+
+    // Split.
+    bseg_t* front = malloc(n * 2 * sizeof(bseg_t));
+    bseg_t* back = malloc(n * 2 * sizeof(bseg_t));
+    int nfront = 0, nback = 0;
+
+    for(int i = 0; i < n; i++)
+    {
+        double da, db;
+
+        switch(Classify(&best, &segs[i], &da, &db))
+        {
+            case SIDE_FRONT:
+                front[nfront++] = segs[i];
+                break;
+
+            case SIDE_BACK:
+                back[nback++] = segs[i];
+                break;
+
+            default:
+            {
+                const double t = da / (da - db);
+                const int x = (int)lrint(segs[i].x1 + t * (segs[i].x2 - segs[i].x1));
+                const int y = (int)lrint(segs[i].y1 + t * (segs[i].y2 - segs[i].y1));
+
+                bseg_t a = segs[i], c = segs[i];
+
+                a.x2 = x, a.y2 = y;
+                c.x1 = x, c.y1 = y;
+                c.offset += (int)lrint(hypot(x - (double)segs[i].x1, y - (double)segs[i].y1));
+
+                if(da < 0)
+                    front[nfront++] = a, back[nback++] = c;
+                else
+                    back[nback++] = a, front[nfront++] = c;
+            }
+        }
+    }
+
+    mapnode_t node;
+
+    node.x = best.px;
+    node.y = best.py;
+    node.dx = best.dx;
+    node.dy = best.dy;
+
+    SegBox(front, nfront, node.bbox[0]);
+    SegBox(back, nback, node.bbox[1]);
+
+    node.children[0] = Build(b, front, nfront, depth + 1);
+    node.children[1] = Build(b, back, nback, depth + 1);
+
+    free(front);
+    free(back);
+
+    if(b->numnodes == b->maxnodes)
+    {
+        b->maxnodes = b->maxnodes * 2 + 64;
+        b->nodes = realloc(b->nodes, b->maxnodes * sizeof(mapnode_t));
+    }
+
+    b->nodes[b->numnodes] = node;
+
+    return b->numnodes++;
+}
+
+//
+// SideTemplates
+// Seg fields that only depend on the line side, taken from the old
+// segs so the new ones match whatever GbaWadUtil wrote.
+//
+static sidetemplate_t* SideTemplates(const map_t* map)
+{
+    sidetemplate_t* sides = calloc(map->numlines * 2 + 1, sizeof(sidetemplate_t));
+
+    for(int i = 0; i < map->numsegs; i++)
+    {
+        const wseg_t* seg = &map->segs[i];
+
+        if(seg->linenum >= map->numlines)
+            continue;
+
+        const wline_t* l = &map->lines[seg->linenum];
+        const double dot = (double)(seg->v2.x - seg->v1.x) * l->dx + (double)(seg->v2.y - seg->v1.y) * l->dy;
+        const int side = dot < 0;
+        const wvertex_t* start = side ? &l->v2 : &l->v1;
+
+        sidetemplate_t* t = &sides[seg->linenum * 2 + side];
+
+        if(t->used)
+            continue;
+
+        t->used = 1;
+        t->angle = seg->angle;
+        t->sidenum = seg->sidenum;
+        t->frontsectornum = seg->frontsectornum;
+        t->backsectornum = seg->backsectornum;
+        t->offset = seg->offset - (int)lrint(hypot(seg->v1.x - (double)start->x, seg->v1.y - (double)start->y));
+    }
+
+    return sides;
+}
+
+static bseg_t* InitialSegs(const map_t* map, const sidetemplate_t* sides, const double* sectorweight, int* count)
+{
+    bseg_t* segs = malloc((map->numlines * 2 + 1) * sizeof(bseg_t));
+    int n = 0;
+
+    for(int i = 0; i < map->numlines * 2; i++)
+    {
+        const wline_t* l = &map->lines[i >> 1];
+
+        if(!sides[i].used || (l->v1.x == l->v2.x && l->v1.y == l->v2.y))
+            continue;
+
+        bseg_t* seg = &segs[n++];
+        const wvertex_t* a = (i & 1) ? &l->v2 : &l->v1;
+        const wvertex_t* c = (i & 1) ? &l->v1 : &l->v2;
+
+        seg->x1 = a->x;
+        seg->y1 = a->y;
+        seg->x2 = c->x;
+        seg->y2 = c->y;
+        seg->key = i;
+        seg->offset = sides[i].offset;
+        seg->weight = sides[i].frontsectornum < map->numsectors ? sectorweight[sides[i].frontsectornum] : 1;
+    }
+
+    *count = n;
+
+    return segs;
+}
+
+static void FreeBuild(build_t* b)
+{
+    free(b->segs);
+    free(b->subsectors);
+    free(b->nodes);
+    free(b->linemark);
+}
+
+static void BuildMapNodes(wad_t* wad, const map_t* map)
+{
+    sidetemplate_t* sides = SideTemplates(map);
+
+    int numviews;
+    sweepview_t* views = SWEEP_Views(map, &numviews);
+
+    // Things per sector, found with the old tree.
+    int* things = calloc(map->numsectors + 1, sizeof(int));
+
+    for(int i = 0; i < map->numthings; i++)
+    {
+        const int ss = SWEEP_PointInSubsector(map, map->things[i].x, map->things[i].y);
+
+        if(ss < map->numsubsectors && map->subsectors[ss].numsegs && map->subsectors[ss].firstseg < map->numsegs)
+        {
+            const int sector = map->segs[map->subsectors[ss].firstseg].frontsectornum;
+
+            if(sector < map->numsectors)
+                things[sector]++;
+        }
+    }
+
+    sweepstats_t oldstats;
+    SWEEP_Run(map, views, numviews, &oldstats);
+
+    const double oldcost = SWEEP_Cost(&oldstats);
+
+    build_t best;
+    double bestcost = oldcost;
+    int besttuning = -1;
+
+    memset(&best, 0, sizeof(best));
+
+    for(int t = 0; t < NUMTUNINGS; t++)
+    {
+        double* weight = malloc((map->numsectors + 1) * sizeof(double));
+
+        for(int s = 0; s < map->numsectors; s++)
+            weight[s] = 1 + tunings[t].thingweight * (things[s] < 8 ? things[s] : 8);
+
+        int numsegs;
+        bseg_t* segs = InitialSegs(map, sides, weight, &numsegs);
+
+        build_t b;
+
+        memset(&b, 0, sizeof(b));
+
+        b.map = map;
+        b.params = &tunings[t];
+        b.sides = sides;
+        b.linemark = calloc(map->numlines + 1, sizeof(int));
+
+        if(numsegs)
+            Build(&b, segs, numsegs, 0);
+
+        free(segs);
+        free(weight);
+
+        map_t trial = *map;
+
+        trial.nodes = b.nodes;
+        trial.numnodes = b.numnodes;
+        trial.segs = b.segs;
+        trial.numsegs = b.numsegs;
+        trial.subsectors = b.subsectors;
+        trial.numsubsectors = b.numsubsectors;
+
+        sweepstats_t stats;
+        SWEEP_Run(&trial, views, numviews, &stats);
+
+        const double cost = SWEEP_Cost(&stats);
+
+        printf("  tuning %d: %d nodes, %d segs, %d subsectors, %d forced, sweep %.1f\n",
+               t, b.numnodes, b.numsegs, b.numsubsectors, b.forced, cost);
+
+        if(numsegs && b.numsegs < NF_SUBSECTOR && b.numsubsectors < NF_SUBSECTOR && cost < bestcost)
+        {
+            FreeBuild(&best);
+            best = b;
+            bestcost = cost;
+            besttuning = t;
+        }
+        else
+            FreeBuild(&b);
+    }
+
+    printf("%.8s: NODES %d views, old tree %d nodes %d segs sweep %.1f "
+           "(%.1f nodes, %.1f bboxes, %.1f subsectors, %.1f segs per view)\n",
+           map->name, numviews, map->numnodes, map->numsegs, oldcost,
+           (double)oldstats.nodes / (numviews ? numviews : 1), (double)oldstats.bboxes / (numviews ? numviews : 1),
+           (double)oldstats.subsectors / (numviews ? numviews : 1), (double)oldstats.segs / (numviews ? numviews : 1));
+
+    if(besttuning < 0)
+        printf("%.8s: NODES kept the old tree\n", map->name);
+    else
+    {
+        printf("%.8s: NODES tuning %d, sweep %.1f -> %.1f (%d%%)\n",
+               map->name, besttuning, oldcost, bestcost, (int)(bestcost * 100 / oldcost));
+
+        WAD_SetLump(wad, map->marker + ML_SEGS, (byte*)best.segs, best.numsegs * sizeof(wseg_t));
+        WAD_SetLump(wad, map->marker + ML_SSECTORS, (byte*)best.subsectors, best.numsubsectors * sizeof(mapsubsector_t));
+        WAD_SetLump(wad, map->marker + ML_NODES, (byte*)best.nodes, best.numnodes * sizeof(mapnode_t));
+
+        // A PVS lists nodes and subsectors of the old tree. -pvs runs
+        // after -nodes and builds a new one.
+        const int pvslump = map->marker + ML_PVS;
+
+        if(pvslump < wad->numlumps && WAD_NameIs(&wad->lumps[pvslump], "PVS"))
+        {
+            printf("%.8s: NODES dropped the old PVS\n", map->name);
+            WAD_DeleteLump(wad, pvslump);
+        }
+
+        best.segs = NULL;
+        best.subsectors = NULL;
+        best.nodes = NULL;
+    }
+
+    FreeBuild(&best);
+    free(things);
+    free(views);
+    free(sides);
+}
+
+void BuildNodes(wad_t* wad)
+{
+    for(int marker = MAP_Find(wad, 0); marker >= 0; marker = MAP_Find(wad, marker + 1))
+    {
+        map_t map;
+
+        if(!MAP_Load(wad, marker, &map))
+            continue;
+
+        BuildMapNodes(wad, &map);
+
+        MAP_Free(&map);
+    }
+}
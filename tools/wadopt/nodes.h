@@ -0,0 +1,15 @@
+#ifndef NODES_H
+#define NODES_H
+
+//
+// Node builder.
+//
+
+#include "wadfile.h"
+
+// Rebuilds NODES, SEGS and SSECTORS of every map with a partition
+// cost tuned for the renderer. A map keeps its old tree unless the
+// render sweep (sweep.h) says the new one is cheaper.
+void BuildNodes(wad_t* wad);
+
+#endif // NODES_H
@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pvs.h"
+#include "mapdata.h"
+#include "vis.h"
+
+#define NF_SUBSECTOR    0x8000
+
+//
+// RenderPortals
+// The renderer looks through every seg with a back sector, which
+// GbaWadUtil sets from the line's second side even without ML_TWOSIDED,
+// so build a portal for each line that has one.
+//
+static visportal_t* RenderPortals(const map_t* map, int* count)
+{
+    char* open = calloc(map->numlines + 1, 1);
+
+    for(int i = 0; i < map->numsegs; i++)
+    {
+        const wseg_t* seg = &map->segs[i];
+
+        if(seg->linenum < map->numlines && seg->backsectornum < map->numsectors)
+            open[seg->linenum] = 1;
+    }
+
+    visportal_t* portals = malloc((map->numlines * 2 + 1) * sizeof(visportal_t));
+    int n = 0;
+
+    for(int i = 0; i < map->numlines; i++)
+    {
+        const wline_t* l = &map->lines[i];
+        const int front = MAP_FrontSector(map, l);
+        int back = MAP_BackSector(map, l);
+
+        if(back < 0 && open[i] && l->sidenum[1] < map->numsides)
+            back = map->sides[l->sidenum[1]].sector;
+
+        if(front < 0 || back < 0)
+            continue;
+
+        const double x1 = l->v1.x / 65536.0, y1 = l->v1.y / 65536.0;
+        const double x2 = l->v2.x / 65536.0, y2 = l->v2.y / 65536.0;
+
+        portals[n++] = (visportal_t){ x1, y1, x2, y2, front, back };
+        portals[n++] = (visportal_t){ x2, y2, x1, y1, back, front };
+    }
+
+    free(open);
+
+    *count = n;
+
+    return portals;
+}
+
+//
+// MarkNode
+// Sets a node's bit if any subsector below it is set.
+//
+static int MarkNode(const map_t* map, byte* row, int child, int depth)
+{
+    if(child & NF_SUBSECTOR)
+    {
+        const int ss = map->numnodes + (child & ~NF_SUBSECTOR);
+
+        return (row[ss >> 3] >> (ss & 7)) & 1;
+    }
+
+    if(child >= map->numnodes || depth > 256)
+        return 1;
+
+    const mapnode_t* node = &map->nodes[child];
+    const int front = MarkNode(map, row, node->children[0], depth + 1);
+    const int back = MarkNode(map, row, node->children[1], depth + 1);
+
+    if(front | back)
+        row[child >> 3] |= 1 << (child & 7);
+
+    return front | back;
+}
+
+//
+// PackRow
+// Quake style: literal bytes, except a zero which is followed by
+// the number of zero bytes in the run.
+//
+static int PackRow(const byte* row, int rowbytes, byte* out)
+{
+    int n = 0;
+
+    for(int i = 0; i < rowbytes; i++)
+    {
+        if(row[i])
+        {
+            out[n++] = row[i];
+            continue;
+        }
+
+        int run = 1;
+
+        while(i + run < rowbytes && !row[i + run] && run < 255)
+            run++;
+
+        out[n++] = 0;
+        out[n++] = run;
+
+        i += run - 1;
+    }
+
+    return n;
+}
+
+static void BuildMapPVS(wad_t* wad, const map_t* map)
+{
+    const int numsectors = map->numsectors;
+    const int bits = map->numnodes + map->numsubsectors;
+    const int rowbytes = (bits + 7) / 8;
+
+    int numportals;
+    visportal_t* portals = RenderPortals(map, &numportals);
+
+    int visbytes;
+    byte* vis = VIS_Compute(portals, numportals, numsectors, &visbytes);
+
+    // Sector of each subsector, from its first seg as in P_LoadSubsectors.
+    int* sssector = malloc((map->numsubsectors + 1) * sizeof(int));
+
+    for(int i = 0; i < map->numsubsectors; i++)
+    {
+        const mapsubsector_t* ss = &map->subsectors[i];
+
+        sssector[i] = -1;
+
+        if(ss->numsegs && ss->firstseg < map->numsegs)
+        {
+            const int sec = map->segs[ss->firstseg].frontsectornum;
+
+            if(sec < numsectors)
+                sssector[i] = sec;
+        }
+    }
+
+    const int headsize = 12 + numsectors * 4;
+    const int maxsize = headsize + numsectors * (rowbytes * 2 + 2) + 4;
+
+    byte* lump = calloc(maxsize, 1);
+    byte* row = malloc(rowbytes + 1);
+    int* rowofs = (int*)(lump + 12);
+    int* rowlen = calloc(numsectors + 1, sizeof(int));
+    int size = headsize;
+    long visible = 0;
+
+    ((unsigned short*)lump)[0] = numsectors;
+    ((unsigned short*)lump)[1] = map->numnodes;
+    ((unsigned short*)lump)[2] = map->numsubsectors;
+    ((unsigned short*)lump)[3] = rowbytes;
+    ((unsigned int*)lump)[2] = PVS_NodesHash((const byte*)map->nodes, map->numnodes * sizeof(mapnode_t));
+
+    for(int s = 0; s < numsectors; s++)
+    {
+        memset(row, 0, rowbytes + 1);
+
+        for(int i = 0; i < map->numsubsectors; i++)
+        {
+            const int sec = sssector[i];
+
+            if(sec < 0 || (vis[s * visbytes + (sec >> 3)] & (1 << (sec & 7))))
+            {
+                const int b = map->numnodes + i;
+                row[b >> 3] |= 1 << (b & 7);
+                visible++;
+            }
+        }
+
+        if(map->numnodes)
+            MarkNode(map, row, map->numnodes - 1, 0);
+
+        const int packed = PackRow(row, rowbytes, lump + size);
+
+        // Sectors that see the same things share one row.
+        rowofs[s] = size;
+        rowlen[s] = packed;
+
+        for(int t = 0; t < s; t++)
+        {
+            if(rowlen[t] == packed && !memcmp(lump + rowofs[t], lump + size, packed))
+            {
+                rowofs[s] = rowofs[t];
+                break;
+            }
+        }
+
+        if(rowofs[s] == size)
+            size += packed;
+    }
+
+    size = (size + 3) & ~3;
+
+    printf("%.8s: PVS %d sectors, %d subsectors, %d%% visible on average, %d bytes\n",
+           map->name, numsectors, map->numsubsectors,
+           (numsectors && map->numsubsectors) ? (int)(visible * 100 / ((long)numsectors * map->numsubsectors)) : 100,
+           size);
+
+    const int lumpnum = map->marker + ML_PVS;
+
+    if(lumpnum < wad->numlumps && WAD_NameIs(&wad->lumps[lumpnum], "PVS"))
+        WAD_SetLump(wad, lumpnum, lump, size);
+    else
+        WAD_InsertLump(wad, lumpnum, "PVS", lump, size);
+
+    free(rowlen);
+    free(row);
+    free(sssector);
+    free(vis);
+    free(portals);
+}
+
+void BuildPVS(wad_t* wad)
+{
+    for(int marker = MAP_Find(wad, 0); marker >= 0; marker = MAP_Find(wad, marker + 1))
+    {
+        map_t map;
+
+        if(!MAP_Load(wad, marker, &map))
+            continue;
+
+        BuildMapPVS(wad, &map);
+
+        MAP_Free(&map);
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef PVS_H
+#define PVS_H
+
+//
+// PVS builder.
+//
+
+#include "wadfile.h"
+
+// Adds or replaces a PVS lump after each map's BLOCKMAP, telling the
+// renderer which nodes and subsectors can be seen from each sector.
+void BuildPVS(wad_t* wad);
+
+#endif // PVS_H
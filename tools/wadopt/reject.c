@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "reject.h"
+#include "mapdata.h"
+#include "vis.h"
+
+static int CountBits(const byte* p, int bits)
+{
+    int n = 0;
+
+    for(int i = 0; i < bits; i++)
+        n += (p[i >> 3] >> (i & 7)) & 1;
+
+    return n;
+}
+
+//
+// SectorPortals
+// Every two sided line is a portal both ways. Heights are ignored
+// as doors and lifts can open any of them during play.
+//
+static visportal_t* SectorPortals(const map_t* map, int* count)
+{
+    visportal_t* portals = malloc((map->numlines * 2 + 1) * sizeof(visportal_t));
+    int n = 0;
+
+    for(int i = 0; i < map->numlines; i++)
+    {
+        const wline_t* l = &map->lines[i];
+        const int front = MAP_FrontSector(map, l);
+        const int back = MAP_BackSector(map, l);
+
+        if(front < 0 || back < 0)
+            continue;
+
+        const double x1 = l->v1.x / 65536.0, y1 = l->v1.y / 65536.0;
+        const double x2 = l->v2.x / 65536.0, y2 = l->v2.y / 65536.0;
+
+        // The front side is on the right of v1->v2.
+        portals[n++] = (visportal_t){ x1, y1, x2, y2, front, back };
+        portals[n++] = (visportal_t){ x2, y2, x1, y1, back, front };
+    }
+
+    *count = n;
+
+    return portals;
+}
+
+void BuildReject(wad_t* wad)
+{
+    for(int marker = MAP_Find(wad, 0); marker >= 0; marker = MAP_Find(wad, marker + 1))
+    {
+        map_t map;
+
+        if(!MAP_Load(wad, marker, &map))
+            continue;
+
+        const int numsectors = map.numsectors;
+        const int pairs = numsectors * numsectors;
+        const int size = (pairs + 7) / 8;
+
+        int numportals;
+        visportal_t* portals = SectorPortals(&map, &numportals);
+
+        int rowbytes;
+        byte* vis = VIS_Compute(portals, numportals, numsectors, &rowbytes);
+
+        byte* reject = calloc(size ? size : 1, 1);
+
+        memcpy(reject, map.reject, size);
+
+        // Sight from either end is enough to keep a pair.
+        for(int i = 0; i < numsectors; i++)
+        {
+            for(int j = 0; j < numsectors; j++)
+            {
+                const int ij = vis[i * rowbytes + (j >> 3)] & (1 << (j & 7));
+                const int ji = vis[j * rowbytes + (i >> 3)] & (1 << (i & 7));
+
+                if(!ij && !ji)
+                {
+                    const int pnum = i * numsectors + j;
+                    reject[pnum >> 3] |= 1 << (pnum & 7);
+                }
+            }
+        }
+
+        const int before = CountBits(map.reject, pairs);
+        const int after = CountBits(reject, pairs);
+
+        printf("%.8s: REJECT %d sectors, %d portals, rejects %d -> %d of %d pairs\n",
+               map.name, numsectors, numportals, before, after, pairs);
+
+        WAD_SetLump(wad, marker + ML_REJECT, reject, size);
+
+        free(vis);
+        free(portals);
+        MAP_Free(&map);
+    }
+}
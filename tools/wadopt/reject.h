@@ -0,0 +1,14 @@
+#ifndef REJECT_H
+#define REJECT_H
+
+//
+// REJECT builder.
+//
+
+#include "wadfile.h"
+
+// Rebuilds the REJECT lump of every map in the wad. Bits already set
+// in the old lump are kept, so play can only get cheaper, never change.
+void BuildReject(wad_t* wad);
+
+#endif // REJECT_H
@@ -0,0 +1,273 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sweep.h"
+
+#define SWEEPWIDTH      120             // SCREENWIDTH
+#define CLIPANGLE       (M_PI / 4)
+
+// Relative costs. R_PointToAngle dominates both R_CheckBBox and
+// R_AddLine; R_Subsector pays for two R_FindPlane lookups.
+#define COST_NODE       1.0
+#define COST_SLOPED     1.0             // FixedMul path in R_PointOnSide
+#define COST_BBOX       4.0
+#define COST_SUBSECTOR  4.0
+#define COST_SEG        4.0
+
+typedef struct
+{
+    const map_t* map;
+    double x, y, angle;
+    char solid[SWEEPWIDTH];
+    sweepstats_t* stats;
+} sweep_t;
+
+static double Norm(double a)
+{
+    while(a > M_PI)
+        a -= 2 * M_PI;
+
+    while(a <= -M_PI)
+        a += 2 * M_PI;
+
+    return a;
+}
+
+static int AngleToX(double a)
+{
+    return (int)floor(SWEEPWIDTH / 2.0 - tan(a) * (SWEEPWIDTH / 2.0) + 0.5);
+}
+
+//
+// Columns
+// Screen columns covered by the arc running clockwise from hi
+// (relative to the view, left positive) through span radians.
+// Returns 0 if it is off screen or too thin to cross a column.
+//
+static int Columns(double hi, double span, int* x1, int* x2)
+{
+    for(double k = -2 * M_PI; k <= 2 * M_PI; k += 2 * M_PI)
+    {
+        double top = hi + k;
+        double bottom = top - span;
+
+        if(bottom >= CLIPANGLE || top <= -CLIPANGLE)
+            continue;
+
+        if(top > CLIPANGLE)
+            top = CLIPANGLE;
+
+        if(bottom < -CLIPANGLE)
+            bottom = -CLIPANGLE;
+
+        *x1 = AngleToX(top);
+        *x2 = AngleToX(bottom);
+
+        return *x1 < *x2;
+    }
+
+    return 0;
+}
+
+static int AnyFree(const sweep_t* s, int x1, int x2)
+{
+    for(int x = x1; x < x2; x++)
+    {
+        if(!s->solid[x])
+            return 1;
+    }
+
+    return 0;
+}
+
+static int PointOnSide(double x, double y, const mapnode_t* node)
+{
+    if(!node->dx)
+        return x <= node->x ? node->dy > 0 : node->dy < 0;
+
+    if(!node->dy)
+        return y <= node->y ? node->dx < 0 : node->dx > 0;
+
+    return (y - node->y) * node->dx >= node->dy * (x - node->x);
+}
+
+static int CheckBBox(sweep_t* s, const short* box)
+{
+    s->stats->bboxes++;
+
+    if(s->x > box[BOXLEFT] && s->x < box[BOXRIGHT] && s->y > box[BOXBOTTOM] && s->y < box[BOXTOP])
+        return 1;
+
+    const double cx[4] = { box[BOXLEFT], box[BOXRIGHT], box[BOXRIGHT], box[BOXLEFT] };
+    const double cy[4] = { box[BOXTOP], box[BOXTOP], box[BOXBOTTOM], box[BOXBOTTOM] };
+
+    const double mid = atan2((box[BOXTOP] + box[BOXBOTTOM]) / 2.0 - s->y,
+                             (box[BOXLEFT] + box[BOXRIGHT]) / 2.0 - s->x);
+    double lo = 0, hi = 0;
+
+    for(int i = 0; i < 4; i++)
+    {
+        const double a = Norm(atan2(cy[i] - s->y, cx[i] - s->x) - mid);
+
+        if(a < lo)
+            lo = a;
+
+        if(a > hi)
+            hi = a;
+    }
+
+    int x1, x2;
+
+    if(!Columns(Norm(mid - s->angle) + hi, hi - lo, &x1, &x2))
+        return 0;
+
+    return AnyFree(s, x1, x2);
+}
+
+static void AddLine(sweep_t* s, const wseg_t* seg)
+{
+    const map_t* map = s->map;
+
+    s->stats->segs++;
+
+    const double a1 = atan2(seg->v1.y / 65536.0 - s->y, seg->v1.x / 65536.0 - s->x);
+    const double a2 = atan2(seg->v2.y / 65536.0 - s->y, seg->v2.x / 65536.0 - s->x);
+
+    double span = a1 - a2;
+
+    while(span < 0)
+        span += 2 * M_PI;
+
+    // Back side.
+    if(span >= M_PI)
+        return;
+
+    int x1, x2;
+
+    if(!Columns(Norm(a1 - s->angle), span, &x1, &x2) || !AnyFree(s, x1, x2))
+        return;
+
+    s->stats->drawn++;
+
+    int solid = seg->backsectornum == NO_INDEX || seg->backsectornum >= map->numsectors ||
+                seg->frontsectornum >= map->numsectors;
+
+    if(!solid)
+    {
+        const mapsector_t* front = &map->sectors[seg->frontsectornum];
+        const mapsector_t* back = &map->sectors[seg->backsectornum];
+
+        solid = back->ceilingheight <= front->floorheight || back->floorheight >= front->ceilingheight;
+    }
+
+    if(solid)
+        memset(s->solid + x1, 1, x2 - x1);
+}
+
+static void Subsector(sweep_t* s, int num)
+{
+    const map_t* map = s->map;
+
+    s->stats->subsectors++;
+
+    if(num >= map->numsubsectors)
+        return;
+
+    const mapsubsector_t* ss = &map->subsectors[num];
+
+    for(int i = 0; i < ss->numsegs && ss->firstseg + i < map->numsegs; i++)
+        AddLine(s, &map->segs[ss->firstseg + i]);
+}
+
+static void Walk(sweep_t* s, int bspnum, int depth)
+{
+    const map_t* map = s->map;
+
+    if(bspnum & NF_SUBSECTOR)
+    {
+        Subsector(s, bspnum == -1 ? 0 : bspnum & ~NF_SUBSECTOR);
+        return;
+    }
+
+    if(bspnum >= map->numnodes || depth > 128)
+        return;
+
+    const mapnode_t* node = &map->nodes[bspnum];
+    const int side = PointOnSide(s->x, s->y, node);
+
+    s->stats->nodes++;
+
+    if(node->dx && node->dy)
+        s->stats->slopednodes++;
+
+    Walk(s, node->children[side], depth + 1);
+
+    if(CheckBBox(s, node->bbox[side ^ 1]))
+        Walk(s, node->children[side ^ 1], depth + 1);
+}
+
+sweepview_t* SWEEP_Views(const map_t* map, int* count)
+{
+    sweepview_t* views = malloc((map->numthings * 8 + 1) * sizeof(sweepview_t));
+    int n = 0;
+
+    for(int i = 0; i < map->numthings; i++)
+    {
+        for(int a = 0; a < 8; a++)
+            views[n++] = (sweepview_t){ map->things[i].x, map->things[i].y, a * M_PI / 4 };
+    }
+
+    *count = n;
+
+    return views;
+}
+
+void SWEEP_Run(const map_t* map, const sweepview_t* views, int numviews, sweepstats_t* stats)
+{
+    sweep_t s;
+
+    memset(stats, 0, sizeof(*stats));
+
+    s.map = map;
+    s.stats = stats;
+
+    for(int i = 0; i < numviews; i++)
+    {
+        s.x = views[i].x;
+        s.y = views[i].y;
+        s.angle = views[i].angle;
+
+        memset(s.solid, 0, sizeof(s.solid));
+
+        Walk(&s, map->numnodes - 1, 0);
+
+        stats->views++;
+    }
+}
+
+double SWEEP_Cost(const sweepstats_t* stats)
+{
+    if(!stats->views)
+        return 0;
+
+    const double total = stats->nodes * COST_NODE + stats->slopednodes * COST_SLOPED +
+                         stats->bboxes * COST_BBOX + stats->subsectors * COST_SUBSECTOR +
+                         stats->segs * COST_SEG;
+
+    return total / stats->views;
+}
+
+int SWEEP_PointInSubsector(const map_t* map, double x, double y)
+{
+    int nodenum = map->numnodes - 1;
+
+    if(!map->numnodes)
+        return 0;
+
+    for(int depth = 0; !(nodenum & NF_SUBSECTOR) && nodenum < map->numnodes && depth < 256; depth++)
+        nodenum = map->nodes[nodenum].children[PointOnSide(x, y, &map->nodes[nodenum])];
+
+    return (nodenum & NF_SUBSECTOR) ? nodenum & ~NF_SUBSECTOR : 0;
+}
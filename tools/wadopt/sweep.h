@@ -0,0 +1,45 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+//
+// Render sweep.
+//
+// A host model of the renderer's front end: R_RenderBSPNode walking
+// the tree, R_CheckBBox on back sides, R_Subsector and R_AddLine
+// clipping segs into a SCREENWIDTH column buffer. It counts the work
+// done from a set of views so node trees can be compared offline.
+//
+
+#include "mapdata.h"
+#include "m_bbox.h"
+
+typedef struct
+{
+    double x, y;            // map units
+    double angle;           // radians
+} sweepview_t;
+
+typedef struct
+{
+    int views;
+    long nodes;             // R_PointOnSide calls
+    long slopednodes;       // of which neither axis aligned
+    long bboxes;            // R_CheckBBox calls
+    long subsectors;        // R_Subsector calls
+    long segs;              // R_AddLine calls
+    long drawn;             // segs that reached a free column
+} sweepstats_t;
+
+// Eight views from the position of every thing in the map,
+// which is where players tend to be.
+sweepview_t* SWEEP_Views(const map_t* map, int* count);
+
+void   SWEEP_Run(const map_t* map, const sweepview_t* views, int numviews, sweepstats_t* stats);
+
+// Estimated front end cost per view, in R_PointOnSide units.
+double SWEEP_Cost(const sweepstats_t* stats);
+
+// Walks the map's nodes like R_PointInSubsector.
+int    SWEEP_PointInSubsector(const map_t* map, double x, double y);
+
+#endif // SWEEP_H
@@ -0,0 +1,335 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "vis.h"
+
+//
+// Portal flow in the style of the Quake vis tool, in 2D.
+//
+// For each source cell a line is traced portal by portal. With the
+// source portal S and the last portal P crossed, the next portal T is
+// cut down to what lies beyond P and between the separating lines of
+// S and P; if nothing is left no straight line gets through. Every
+// clip keeps a little extra (EPS), never less, so the result errs
+// towards visible. EPS is generous because P_CheckSight drops the
+// fractions before its side tests and can see past a corner by that.
+//
+
+#define EPS         2.0             // map units kept either side of a clip
+#define MAXSTEPS    (1 << 20)       // per source cell, then fall back to the flood
+
+typedef struct
+{
+    double ax, ay, bx, by;
+} vseg_t;
+
+#define BIT(set, i)     ((set)[(i) >> 5] & (1u << ((i) & 31)))
+#define SETBIT(set, i)  ((set)[(i) >> 5] |= (1u << ((i) & 31)))
+
+typedef struct
+{
+    const visportal_t* portals;
+    int numportals;
+    int numcells;
+
+    int* firstportal;           // portals leaving each cell, numcells + 1
+    int* cellportals;
+
+    int portalwords;
+    unsigned int* mightsee;     // per portal, portals a line through it might reach
+    unsigned int* portalvis;    // portals reached from the current source
+    unsigned int* cellvis;      // cells reached from the current source
+    unsigned int* stack;        // one might-see set per recursion level
+    char* inpath;
+
+    long steps;
+    int overflow;
+} vis_t;
+
+static double Side(const visportal_t* l, double x, double y)
+{
+    const double dx = l->bx - l->ax;
+    const double dy = l->by - l->ay;
+
+    return dx * (y - l->ay) - dy * (x - l->ax);
+}
+
+//
+// Clip
+// Keeps the part of s on the sign side of the line a->b, plus EPS.
+// Returns 0 if nothing is left.
+//
+static int Clip(vseg_t* s, double ax, double ay, double bx, double by, double sign)
+{
+    const double dx = bx - ax;
+    const double dy = by - ay;
+    const double len = sqrt(dx * dx + dy * dy);
+
+    if(len < 1e-9)
+        return 1;
+
+    const double fa = sign * (dx * (s->ay - ay) - dy * (s->ax - ax)) / len;
+    const double fb = sign * (dx * (s->by - ay) - dy * (s->bx - ax)) / len;
+
+    if(fa >= -EPS && fb >= -EPS)
+        return 1;
+
+    if(fa < -EPS && fb < -EPS)
+        return 0;
+
+    const double t = (fa + EPS) / (fa - fb);
+    const double x = s->ax + t * (s->bx - s->ax);
+    const double y = s->ay + t * (s->by - s->ay);
+
+    if(fa < -EPS)
+        s->ax = x, s->ay = y;
+    else
+        s->bx = x, s->by = y;
+
+    return 1;
+}
+
+static int ClipToPortal(vseg_t* s, const visportal_t* p, double sign)
+{
+    return Clip(s, p->ax, p->ay, p->bx, p->by, sign);
+}
+
+//
+// ClipSeparators
+// Cuts t down to the lines that can pass through s and then p.
+// A line through an end of s and an end of p bounds them if s and
+// p lie on opposite sides of it, and t must be on p's side.
+//
+static int ClipSeparators(vseg_t* t, const vseg_t* s, const vseg_t* p)
+{
+    const double sx[2] = { s->ax, s->bx }, sy[2] = { s->ay, s->by };
+    const double px[2] = { p->ax, p->bx }, py[2] = { p->ay, p->by };
+
+    for(int i = 0; i < 2; i++)
+    {
+        for(int j = 0; j < 2; j++)
+        {
+            const double dx = px[j] - sx[i];
+            const double dy = py[j] - sy[i];
+
+            const double fs = dx * (sy[i ^ 1] - sy[i]) - dy * (sx[i ^ 1] - sx[i]);
+            const double fp = dx * (py[j ^ 1] - sy[i]) - dy * (px[j ^ 1] - sx[i]);
+
+            if((fs > 0 && fp > 0) || (fs < 0 && fp < 0) || (fs == 0 && fp == 0))
+                continue;
+
+            const double sign = fp > 0 ? 1 : fp < 0 ? -1 : (fs > 0 ? -1 : 1);
+
+            if(!Clip(t, sx[i], sy[i], px[j], py[j], sign))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+//
+// InFront
+// Can a line cross p and then q? Only if some of q is beyond p
+// and some of p is before q.
+//
+static int InFront(const visportal_t* p, const visportal_t* q)
+{
+    const double lp = hypot(p->bx - p->ax, p->by - p->ay);
+    const double lq = hypot(q->bx - q->ax, q->by - q->ay);
+
+    if(Side(p, q->ax, q->ay) < -EPS * lp && Side(p, q->bx, q->by) < -EPS * lp)
+        return 0;
+
+    if(Side(q, p->ax, p->ay) > EPS * lq && Side(q, p->bx, p->by) > EPS * lq)
+        return 0;
+
+    return 1;
+}
+
+static void SimpleFlood(vis_t* v, int p, unsigned int* might, int cell)
+{
+    for(int k = v->firstportal[cell]; k < v->firstportal[cell + 1]; k++)
+    {
+        const int q = v->cellportals[k];
+
+        if(BIT(might, q) || !InFront(&v->portals[p], &v->portals[q]))
+            continue;
+
+        SETBIT(might, q);
+        SimpleFlood(v, p, might, v->portals[q].dst);
+    }
+}
+
+static void Flow(vis_t* v, int src, const vseg_t* s, int pass, const vseg_t* p, const unsigned int* might, int depth)
+{
+    const int cell = v->portals[pass].dst;
+    unsigned int* newmight = v->stack + (size_t)(depth + 1) * v->portalwords;
+
+    for(int k = v->firstportal[cell]; k < v->firstportal[cell + 1]; k++)
+    {
+        const int q = v->cellportals[k];
+        const visportal_t* pq = &v->portals[q];
+
+        if(!BIT(might, q) || v->inpath[q])
+            continue;
+
+        if(++v->steps > MAXSTEPS)
+        {
+            v->overflow = 1;
+            return;
+        }
+
+        // Stop if nothing new could be reached through q.
+        const unsigned int* qmight = v->mightsee + (size_t)q * v->portalwords;
+        unsigned int more = 0;
+
+        for(int w = 0; w < v->portalwords; w++)
+        {
+            newmight[w] = might[w] & qmight[w];
+            more |= newmight[w] & ~v->portalvis[w];
+        }
+
+        if(!more && BIT(v->cellvis, pq->dst))
+            continue;
+
+        vseg_t t = { pq->ax, pq->ay, pq->bx, pq->by };
+
+        if(!ClipToPortal(&t, &v->portals[pass], 1) || !ClipToPortal(&t, &v->portals[src], 1))
+            continue;
+
+        if(!ClipSeparators(&t, s, p))
+            continue;
+
+        // And the part of the source that can still see t.
+        vseg_t s2 = *s;
+
+        if(!ClipToPortal(&s2, pq, -1) || !ClipSeparators(&s2, &t, p))
+            continue;
+
+        SETBIT(v->cellvis, pq->dst);
+        SETBIT(v->portalvis, q);
+
+        if(!more)
+            continue;
+
+        v->inpath[q] = 1;
+        Flow(v, src, &s2, q, &t, newmight, depth + 1);
+        v->inpath[q] = 0;
+
+        if(v->overflow)
+            return;
+    }
+}
+
+unsigned char* VIS_Compute(const visportal_t* portals, int numportals, int numcells, int* rowbytes)
+{
+    vis_t v;
+
+    memset(&v, 0, sizeof(v));
+
+    v.portals = portals;
+    v.numportals = numportals;
+    v.numcells = numcells;
+    v.portalwords = (numportals + 31) / 32 + 1;
+
+    v.firstportal = calloc(numcells + 1, sizeof(int));
+    v.cellportals = malloc((numportals + 1) * sizeof(int));
+
+    for(int i = 0; i < numportals; i++)
+        v.firstportal[portals[i].src + 1]++;
+
+    for(int i = 0; i < numcells; i++)
+        v.firstportal[i + 1] += v.firstportal[i];
+
+    int* fill = malloc((numcells + 1) * sizeof(int));
+    memcpy(fill, v.firstportal, (numcells + 1) * sizeof(int));
+
+    for(int i = 0; i < numportals; i++)
+        v.cellportals[fill[portals[i].src]++] = i;
+
+    free(fill);
+
+    v.mightsee = calloc((size_t)numportals * v.portalwords + 1, sizeof(unsigned int));
+
+    for(int i = 0; i < numportals; i++)
+        SimpleFlood(&v, i, v.mightsee + (size_t)i * v.portalwords, portals[i].dst);
+
+    const int cellwords = (numcells + 31) / 32;
+
+    v.portalvis = malloc(v.portalwords * sizeof(unsigned int));
+    v.cellvis = malloc((cellwords + 1) * sizeof(unsigned int));
+    v.stack = malloc((size_t)(numportals + 2) * v.portalwords * sizeof(unsigned int));
+    v.inpath = calloc(numportals + 1, 1);
+
+    *rowbytes = (numcells + 7) / 8;
+
+    unsigned char* out = calloc((size_t)numcells * *rowbytes + 1, 1);
+    int overflows = 0;
+
+    for(int c = 0; c < numcells; c++)
+    {
+        memset(v.portalvis, 0, v.portalwords * sizeof(unsigned int));
+        memset(v.cellvis, 0, (cellwords + 1) * sizeof(unsigned int));
+
+        v.steps = 0;
+        v.overflow = 0;
+
+        SETBIT(v.cellvis, c);
+
+        for(int k = v.firstportal[c]; k < v.firstportal[c + 1] && !v.overflow; k++)
+        {
+            const int p = v.cellportals[k];
+            const vseg_t s = { portals[p].ax, portals[p].ay, portals[p].bx, portals[p].by };
+
+            SETBIT(v.cellvis, portals[p].dst);
+            SETBIT(v.portalvis, p);
+
+            v.inpath[p] = 1;
+            Flow(&v, p, &s, p, &s, v.mightsee + (size_t)p * v.portalwords, 0);
+            v.inpath[p] = 0;
+        }
+
+        if(v.overflow)
+        {
+            // Too many paths, settle for everything the flood reached.
+            overflows++;
+            memset(v.inpath, 0, numportals);
+
+            for(int k = v.firstportal[c]; k < v.firstportal[c + 1]; k++)
+            {
+                const int p = v.cellportals[k];
+                const unsigned int* might = v.mightsee + (size_t)p * v.portalwords;
+
+                SETBIT(v.cellvis, portals[p].dst);
+
+                for(int q = 0; q < numportals; q++)
+                {
+                    if(BIT(might, q))
+                        SETBIT(v.cellvis, portals[q].dst);
+                }
+            }
+        }
+
+        for(int j = 0; j < numcells; j++)
+        {
+            if(BIT(v.cellvis, j))
+                out[(size_t)c * *rowbytes + (j >> 3)] |= 1 << (j & 7);
+        }
+    }
+
+    if(overflows)
+        printf("  %d of %d cells hit the step limit and use the flood\n", overflows, numcells);
+
+    free(v.inpath);
+    free(v.stack);
+    free(v.cellvis);
+    free(v.portalvis);
+    free(v.mightsee);
+    free(v.cellportals);
+    free(v.firstportal);
+
+    return out;
+}
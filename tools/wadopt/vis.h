@@ -0,0 +1,23 @@
+#ifndef VIS_H
+#define VIS_H
+
+//
+// Conservative cell to cell visibility through portals.
+//
+// A cell is any region whose boundary is made of solid walls and
+// portals (sectors for REJECT). Two cells are marked as seeing each
+// other unless no straight line can run from one to the other through
+// portals only, so the result is always a superset of real sight.
+//
+
+typedef struct
+{
+    double ax, ay, bx, by;  // in map units, src on the right of a->b
+    int src, dst;           // cells on each side
+} visportal_t;
+
+// Returns numcells rows of rowbytes bytes, bit j of row i set if cell
+// i might see cell j. Rows are not forced to be symmetric.
+unsigned char* VIS_Compute(const visportal_t* portals, int numportals, int numcells, int* rowbytes);
+
+#endif // VIS_H
@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "wadfile.h"
+
+#define LUMP_COMPRESSED 0x80000000u
+
+static unsigned int ReadInt(const byte* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static void WriteInt(byte* p, unsigned int v)
+{
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+static int IsCFile(const char* filename)
+{
+    const char* ext = strrchr(filename, '.');
+
+    return ext && (!strcmp(ext, ".c") || !strcmp(ext, ".h"));
+}
+
+static byte* ReadFile(const char* filename, int* len)
+{
+    FILE* f = fopen(filename, "rb");
+
+    if(!f)
+        return NULL;
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    byte* buf = malloc(size + 1);
+
+    if(fread(buf, 1, size, f) != (size_t)size)
+    {
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+
+    fclose(f);
+
+    buf[size] = 0;
+    *len = (int)size;
+
+    return buf;
+}
+
+//
+// ParseCArray
+// Pulls the bytes back out of a C array written by
+// GbaWadUtil or WAD_Save.
+//
+static byte* ParseCArray(const char* text, int* len)
+{
+    const char* p = strchr(text, '{');
+
+    if(!p)
+        return NULL;
+
+    int cap = 1 << 20;
+    int n = 0;
+    byte* out = malloc(cap);
+
+    p++;
+
+    while(*p && *p != '}')
+    {
+        if(isdigit((unsigned char)*p))
+        {
+            char* end;
+            unsigned long v = strtoul(p, &end, 0);
+
+            if(n == cap)
+            {
+                cap *= 2;
+                out = realloc(out, cap);
+            }
+
+            out[n++] = (byte)v;
+            p = end;
+        }
+        else
+        {
+            p++;
+        }
+    }
+
+    *len = n;
+
+    return out;
+}
+
+int WAD_Load(wad_t* wad, const char* filename)
+{
+    int len;
+    byte* file = ReadFile(filename, &len);
+
+    memset(wad, 0, sizeof(*wad));
+
+    if(!file)
+    {
+        fprintf(stderr, "Can't read %s\n", filename);
+        return 0;
+    }
+
+    if(IsCFile(filename))
+    {
+        byte* bytes = ParseCArray((const char*)file, &len);
+        free(file);
+        file = bytes;
+
+        if(!file)
+        {
+            fprintf(stderr, "%s has no byte array\n", filename);
+            return 0;
+        }
+    }
+
+    if(len < 12 || (memcmp(file, "IWAD", 4) && memcmp(file, "PWAD", 4)))
+    {
+        fprintf(stderr, "%s is not a wad\n", filename);
+        free(file);
+        return 0;
+    }
+
+    int numlumps = ReadInt(file + 4);
+    unsigned int infotableofs = ReadInt(file + 8);
+
+    if(numlumps < 0 || infotableofs + (unsigned int)numlumps * 16 > (unsigned int)len)
+    {
+        fprintf(stderr, "%s has a bad directory\n", filename);
+        free(file);
+        return 0;
+    }
+
+    memcpy(wad->id, file, 4);
+    wad->numlumps = numlumps;
+    wad->maxlumps = numlumps + 64;
+    wad->lumps = calloc(wad->maxlumps, sizeof(wadlump_t));
+
+    for(int i = 0; i < numlumps; i++)
+    {
+        const byte* fi = file + infotableofs + i * 16;
+        wadlump_t* l = &wad->lumps[i];
+
+        unsigned int filepos = ReadInt(fi);
+        int size = ReadInt(fi + 4);
+
+        memcpy(l->name, fi + 8, 8);
+
+        if(filepos & LUMP_COMPRESSED)
+        {
+            filepos &= ~LUMP_COMPRESSED;
+
+            l->flags = LUMPF_COMPRESSED;
+            l->rawsize = size;
+            size = 4 + ReadInt(file + filepos);
+        }
+
+        if(filepos + (unsigned int)size > (unsigned int)len)
+        {
+            fprintf(stderr, "%s: lump %.8s is out of range\n", filename, l->name);
+            WAD_Free(wad);
+            free(file);
+            return 0;
+        }
+
+        l->size = size;
+        l->data = malloc(size ? size : 1);
+        memcpy(l->data, file + filepos, size);
+    }
+
+    free(file);
+
+    return 1;
+}
+
+//
+// WAD_Save
+// Lumps are padded to 4 bytes as the engine reads
+// them in place as arrays of ints and shorts.
+//
+int WAD_Save(const wad_t* wad, const char* filename, int ascfile)
+{
+    int len = 12;
+
+    for(int i = 0; i < wad->numlumps; i++)
+        len += (wad->lumps[i].size + 3) & ~3;
+
+    const int infotableofs = len;
+    len += wad->numlumps * 16;
+
+    byte* out = calloc(len, 1);
+
+    memcpy(out, wad->id, 4);
+    WriteInt(out + 4, wad->numlumps);
+    WriteInt(out + 8, infotableofs);
+
+    int pos = 12;
+
+    for(int i = 0; i < wad->numlumps; i++)
+    {
+        const wadlump_t* l = &wad->lumps[i];
+        byte* fi = out + infotableofs + i * 16;
+
+        memcpy(out + pos, l->data, l->size);
+
+        if(l->flags & LUMPF_COMPRESSED)
+        {
+            WriteInt(fi, pos | LUMP_COMPRESSED);
+            WriteInt(fi + 4, l->rawsize);
+        }
+        else
+        {
+            WriteInt(fi, pos);
+            WriteInt(fi + 4, l->size);
+        }
+
+        memcpy(fi + 8, l->name, 8);
+
+        pos += (l->size + 3) & ~3;
+    }
+
+    FILE* f = fopen(filename, ascfile ? "w" : "wb");
+
+    if(!f)
+    {
+        fprintf(stderr, "Can't write %s\n", filename);
+        free(out);
+        return 0;
+    }
+
+    if(ascfile)
+    {
+        fprintf(f, "const unsigned char doom_iwad[] __attribute__((aligned(4))) = {\n");
+
+        for(int i = 0; i < len; i++)
+            fprintf(f, "0x%02x,%s", out[i], ((i & 15) == 15) ? "\n" : "");
+
+        fprintf(f, "\n};\n");
+    }
+    else
+    {
+        fwrite(out, 1, len, f);
+    }
+
+    fclose(f);
+    free(out);
+
+    return 1;
+}
+
+void WAD_Free(wad_t* wad)
+{
+    for(int i = 0; i < wad->numlumps; i++)
+        free(wad->lumps[i].data);
+
+    free(wad->lumps);
+    memset(wad, 0, sizeof(*wad));
+}
+
+int WAD_NameIs(const wadlump_t* lump, const char* name)
+{
+    return !strncasecmp(lump->name, name, 8);
+}
+
+int WAD_FindLumpFrom(const wad_t* wad, const char* name, int start)
+{
+    for(int i = start; i < wad->numlumps; i++)
+    {
+        if(WAD_NameIs(&wad->lumps[i], name))
+            return i;
+    }
+
+    return -1;
+}
+
+//
+// WAD_FindLump
+// Last lump of that name wins, as in the engine.
+//
+int WAD_FindLump(const wad_t* wad, const char* name)
+{
+    for(int i = wad->numlumps - 1; i >= 0; i--)
+    {
+        if(WAD_NameIs(&wad->lumps[i], name))
+            return i;
+    }
+
+    return -1;
+}
+
+void WAD_SetLump(wad_t* wad, int lump, byte* data, int size)
+{
+    wadlump_t* l = &wad->lumps[lump];
+
+    free(l->data);
+
+    l->data = data;
+    l->size = size;
+    l->rawsize = 0;
+    l->flags = 0;
+}
+
+int WAD_InsertLump(wad_t* wad, int pos, const char* name, byte* data, int size)
+{
+    if(wad->numlumps == wad->maxlumps)
+    {
+        wad->maxlumps *= 2;
+        wad->lumps = realloc(wad->lumps, wad->maxlumps * sizeof(wadlump_t));
+    }
+
+    memmove(&wad->lumps[pos + 1], &wad->lumps[pos], (wad->numlumps - pos) * sizeof(wadlump_t));
+    wad->numlumps++;
+
+    wadlump_t* l = &wad->lumps[pos];
+
+    memset(l, 0, sizeof(*l));
+    memcpy(l->name, name, strnlen(name, 8));
+    l->data = data;
+    l->size = size;
+
+    return pos;
+}
+
+void WAD_DeleteLump(wad_t* wad, int pos)
+{
+    free(wad->lumps[pos].data);
+
+    memmove(&wad->lumps[pos], &wad->lumps[pos + 1], (wad->numlumps - pos - 1) * sizeof(wadlump_t));
+    wad->numlumps--;
+}
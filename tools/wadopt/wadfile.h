@@ -0,0 +1,50 @@
+#ifndef WADFILE_H
+#define WADFILE_H
+
+//
+// In-memory wad for the offline tools.
+//
+// Wads can be read from and written to either a plain .wad
+// or a GbaWadUtil style C array (const unsigned char doom_iwad[]).
+//
+
+typedef unsigned char byte;
+
+// Lump was stored as an lzlump_t; size is the decompressed length.
+#define LUMPF_COMPRESSED    1
+
+typedef struct
+{
+    char name[8];
+    byte* data;
+    int size;       // bytes in data
+    int rawsize;    // decompressed size if LUMPF_COMPRESSED
+    int flags;
+} wadlump_t;
+
+typedef struct
+{
+    char id[4];
+    int numlumps;
+    int maxlumps;
+    wadlump_t* lumps;
+} wad_t;
+
+int  WAD_Load(wad_t* wad, const char* filename);
+int  WAD_Save(const wad_t* wad, const char* filename, int ascfile);
+void WAD_Free(wad_t* wad);
+
+int  WAD_FindLump(const wad_t* wad, const char* name);
+int  WAD_FindLumpFrom(const wad_t* wad, const char* name, int start);
+
+// Replaces the data of a lump. Takes ownership of data.
+void WAD_SetLump(wad_t* wad, int lump, byte* data, int size);
+
+// Inserts a new lump before position pos. Takes ownership of data.
+int  WAD_InsertLump(wad_t* wad, int pos, const char* name, byte* data, int size);
+
+void WAD_DeleteLump(wad_t* wad, int pos);
+
+int  WAD_NameIs(const wadlump_t* lump, const char* name);
+
+#endif // WADFILE_H
@@ -0,0 +1,411 @@
+//
+// wadopt - offline optimiser for GBADoom/PicoDoom wads.
+//
+// Runs on the host, after GbaWadUtil. Build with:
+//
+//   gcc -O2 -std=gnu11 -I../../include -o wadopt *.c ../../source/w_lz.c -lm
+//
+// The decoder is the engine's own w_lz.c so what -bench measures
+// and what -compress verifies is exactly what runs on the device.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "wadfile.h"
+#include "lz4enc.h"
+#include "reject.h"
+#include "pvs.h"
+#include "nodes.h"
+#include "blockmap.h"
+#include "w_lz.h"
+
+enum
+{
+    CMP_SPRITES = 1,
+    CMP_FLATS = 2,
+    CMP_PATCHES = 4,
+    CMP_MAPS = 8
+};
+
+static const char* const maplumps[] =
+{
+    "THINGS", "LINEDEFS", "SIDEDEFS", "VERTEXES", "SEGS",
+    "SSECTORS", "NODES", "SECTORS", "REJECT", "BLOCKMAP", "PVS", NULL
+};
+
+static void Usage(void)
+{
+    printf("Usage: wadopt -in <wad|c> [-out <wad>] [-cfile <c>] [options]\n"
+           "  -compress <list>  LZ4 compress lumps. list is comma separated:\n"
+           "                    sprites, flats, patches, maps (default sprites,flats)\n"
+           "  -nodes            rebuild NODES, SEGS and SSECTORS for render cost\n"
+           "  -blockmap         store BLOCKMAP lists without duplicates or sentinels\n"
+           "  -blockunits <n>   rebuild BLOCKMAP from the lines with n unit blocks\n"
+           "                    (128, 64 or 32). Lists change, so demos may desync\n"
+           "  -reject           rebuild REJECT from portal visibility\n"
+           "  -pvs              add a PVS lump so the renderer skips hidden subsectors\n"
+           "  -bench            time decompression against a plain copy\n");
+}
+
+static int ParseCompress(const char* list)
+{
+    int mask = 0;
+    char buf[256];
+
+    strncpy(buf, list, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+
+    for(char* tok = strtok(buf, ","); tok; tok = strtok(NULL, ","))
+    {
+        if(!strcmp(tok, "sprites"))
+            mask |= CMP_SPRITES;
+        else if(!strcmp(tok, "flats"))
+            mask |= CMP_FLATS;
+        else if(!strcmp(tok, "patches"))
+            mask |= CMP_PATCHES;
+        else if(!strcmp(tok, "maps"))
+            mask |= CMP_MAPS;
+        else
+        {
+            fprintf(stderr, "Unknown lump class '%s'\n", tok);
+            exit(1);
+        }
+    }
+
+    return mask;
+}
+
+//
+// MarkNamespace
+// Flags the lumps between x_START and x_END (or xx_START/xx_END).
+//
+static void MarkNamespace(const wad_t* wad, char* mark, char c)
+{
+    char start[2][9], end[2][9];
+
+    snprintf(start[0], 9, "%c_START", c);
+    snprintf(start[1], 9, "%c%c_START", c, c);
+    snprintf(end[0], 9, "%c_END", c);
+    snprintf(end[1], 9, "%c%c_END", c, c);
+
+    int inside = 0;
+
+    for(int i = 0; i < wad->numlumps; i++)
+    {
+        const wadlump_t* l = &wad->lumps[i];
+
+        if(WAD_NameIs(l, start[0]) || WAD_NameIs(l, start[1]))
+            inside = 1;
+        else if(WAD_NameIs(l, end[0]) || WAD_NameIs(l, end[1]))
+            inside = 0;
+        else if(inside && l->size > 0)
+            mark[i] = 1;
+    }
+}
+
+static void MarkPatches(const wad_t* wad, char* mark)
+{
+    const int pnames = WAD_FindLump(wad, "PNAMES");
+
+    if(pnames < 0)
+        return;
+
+    const wadlump_t* p = &wad->lumps[pnames];
+    const int count = p->data[0] | (p->data[1] << 8);
+
+    for(int i = 0; i < count && 4 + (i + 1) * 8 <= p->size; i++)
+    {
+        char name[9] = {0};
+        memcpy(name, p->data + 4 + i * 8, 8);
+
+        const int lump = WAD_FindLump(wad, name);
+
+        if(lump >= 0)
+            mark[lump] = 1;
+    }
+}
+
+static void MarkMaps(const wad_t* wad, char* mark)
+{
+    for(int i = 0; i < wad->numlumps - 1; i++)
+    {
+        if(!WAD_NameIs(&wad->lumps[i + 1], "THINGS"))
+            continue;
+
+        for(int j = i + 1; j < wad->numlumps; j++)
+        {
+            int known = 0;
+
+            for(int k = 0; maplumps[k]; k++)
+                known |= WAD_NameIs(&wad->lumps[j], maplumps[k]);
+
+            if(!known)
+                break;
+
+            mark[j] = 1;
+        }
+    }
+}
+
+//
+// CompressWad
+// Lumps are only replaced if LZ4 actually saves space.
+// Every block is decoded again to check it round trips.
+//
+static void CompressWad(wad_t* wad, int mask)
+{
+    char* mark = calloc(wad->numlumps, 1);
+
+    if(mask & CMP_SPRITES)
+        MarkNamespace(wad, mark, 'S');
+
+    if(mask & CMP_FLATS)
+        MarkNamespace(wad, mark, 'F');
+
+    if(mask & CMP_PATCHES)
+        MarkPatches(wad, mark);
+
+    if(mask & CMP_MAPS)
+        MarkMaps(wad, mark);
+
+    int count = 0;
+    long before = 0, after = 0;
+
+    for(int i = 0; i < wad->numlumps; i++)
+    {
+        wadlump_t* l = &wad->lumps[i];
+
+        if(!mark[i] || (l->flags & LUMPF_COMPRESSED) || l->size == 0)
+            continue;
+
+        byte* out = malloc(4 + LZ4_BOUND(l->size));
+        const int csize = LZ4_Compress(l->data, l->size, out + 4);
+
+        if(((4 + csize + 3) & ~3) >= ((l->size + 3) & ~3))
+        {
+            free(out);
+            continue;
+        }
+
+        byte* check = malloc(l->size);
+
+        if(W_LZDecompress(out + 4, csize, check, l->size) != l->size || memcmp(check, l->data, l->size))
+        {
+            fprintf(stderr, "LZ4 round trip failed on %.8s\n", l->name);
+            exit(1);
+        }
+
+        free(check);
+
+        out[0] = csize & 0xff;
+        out[1] = (csize >> 8) & 0xff;
+        out[2] = (csize >> 16) & 0xff;
+        out[3] = (csize >> 24) & 0xff;
+
+        const int rawsize = l->size;
+
+        before += rawsize;
+        after += 4 + csize;
+        count++;
+
+        WAD_SetLump(wad, i, out, 4 + csize);
+        l->rawsize = rawsize;
+        l->flags = LUMPF_COMPRESSED;
+    }
+
+    free(mark);
+
+    printf("Compressed %d lumps: %ld -> %ld bytes", count, before, after);
+
+    if(before)
+        printf(" (%ld%%)", (after * 100) / before);
+
+    printf("\n");
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//
+// Bench
+// Decodes every compressed lump against a memcpy of the same
+// size, which stands in for reading the lump in place from flash.
+//
+static void Bench(const wad_t* wad)
+{
+    long total = 0;
+    int maxsize = 0;
+
+    for(int i = 0; i < wad->numlumps; i++)
+    {
+        const wadlump_t* l = &wad->lumps[i];
+
+        if(l->flags & LUMPF_COMPRESSED)
+        {
+            total += l->rawsize;
+
+            if(l->rawsize > maxsize)
+                maxsize = l->rawsize;
+        }
+    }
+
+    if(!total)
+    {
+        printf("No compressed lumps to benchmark.\n");
+        return;
+    }
+
+    byte* src = calloc(maxsize, 1);
+    byte* dest = malloc(maxsize);
+
+    const int passes = (int)(((64L << 20) / total) + 1);
+
+    double t = Now();
+
+    for(int p = 0; p < passes; p++)
+    {
+        for(int i = 0; i < wad->numlumps; i++)
+        {
+            const wadlump_t* l = &wad->lumps[i];
+
+            if(l->flags & LUMPF_COMPRESSED)
+                W_LZDecompress(l->data + 4, l->size - 4, dest, l->rawsize);
+        }
+    }
+
+    const double tlz = Now() - t;
+
+    t = Now();
+
+    for(int p = 0; p < passes; p++)
+    {
+        for(int i = 0; i < wad->numlumps; i++)
+        {
+            const wadlump_t* l = &wad->lumps[i];
+
+            if(l->flags & LUMPF_COMPRESSED)
+            {
+                memcpy(dest, src, l->rawsize);
+                __asm__ volatile("" : : "r"(dest) : "memory");
+            }
+        }
+    }
+
+    const double tcopy = Now() - t;
+
+    const double mb = (double)total * passes / (1 << 20);
+
+    printf("Decompress: %8.1f MB/s\n", mb / tlz);
+    printf("Copy (XIP): %8.1f MB/s\n", mb / tcopy);
+    printf("Ratio:      %8.1fx slower\n", tlz / tcopy);
+
+    free(dest);
+    free(src);
+}
+
+int main(int argc, char** argv)
+{
+    const char* in = NULL;
+    const char* out = NULL;
+    const char* cfile = NULL;
+    int compress = 0;
+    int nodes = 0;
+    int blockmap = 0, blockunits = 0;
+    int reject = 0;
+    int pvs = 0;
+    int bench = 0;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(!strcmp(argv[i], "-in") && i + 1 < argc)
+            in = argv[++i];
+        else if(!strcmp(argv[i], "-out") && i + 1 < argc)
+            out = argv[++i];
+        else if(!strcmp(argv[i], "-cfile") && i + 1 < argc)
+            cfile = argv[++i];
+        else if(!strcmp(argv[i], "-compress"))
+        {
+            if(i + 1 < argc && argv[i + 1][0] != '-')
+                compress = ParseCompress(argv[++i]);
+            else
+                compress = CMP_SPRITES | CMP_FLATS;
+        }
+        else if(!strcmp(argv[i], "-nodes"))
+            nodes = 1;
+        else if(!strcmp(argv[i], "-blockmap"))
+            blockmap = 1;
+        else if(!strcmp(argv[i], "-blockunits") && i + 1 < argc)
+        {
+            blockmap = 1;
+            blockunits = atoi(argv[++i]);
+
+            if(blockunits != 128 && blockunits != 64 && blockunits != 32)
+            {
+                Usage();
+                return 1;
+            }
+        }
+        else if(!strcmp(argv[i], "-reject"))
+            reject = 1;
+        else if(!strcmp(argv[i], "-pvs"))
+            pvs = 1;
+        else if(!strcmp(argv[i], "-bench"))
+            bench = 1;
+        else
+        {
+            Usage();
+            return 1;
+        }
+    }
+
+    if(!in)
+    {
+        Usage();
+        return 1;
+    }
+
+    wad_t wad;
+
+    if(!WAD_Load(&wad, in))
+        return 1;
+
+    printf("%s: %d lumps\n", in, wad.numlumps);
+
+    // Map passes work on plain lumps, so they go before compression.
+    // The PVS is built from the nodes, so they come first.
+    if(nodes)
+        BuildNodes(&wad);
+
+    if(blockmap)
+        BuildBlockmap(&wad, blockunits);
+
+    if(reject)
+        BuildReject(&wad);
+
+    if(pvs)
+        BuildPVS(&wad);
+
+    if(compress)
+        CompressWad(&wad, compress);
+
+    if(bench)
+        Bench(&wad);
+
+    if(out && !WAD_Save(&wad, out, 0))
+        return 1;
+
+    if(cfile && !WAD_Save(&wad, cfile, 1))
+        return 1;
+
+    WAD_Free(&wad);
+
+    return 0;
+}